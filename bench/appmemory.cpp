@@ -0,0 +1,98 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * qmpanel - a minimal Qt-based desktop panel
+ *
+ * Copyright: 2026 John Lindgren
+ * Authors:
+ *   John Lindgren <john@jlindgren.net>
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+// Measures the heap memory held per application: by the GDesktopAppInfo
+// objects the panel kept before, and by the compact records it keeps
+// now (plus the AppScan file list, which it also keeps).
+
+#include "appscan.h"
+#include "bench.h"
+#include "desktopfile.h"
+#include "desktoptree.h"
+
+#include <gio/gio.h>
+#include <malloc.h>
+
+static const int entryCount = 5000;
+
+// includes large blocks, which malloc() maps separately
+static size_t heapInUse()
+{
+    auto info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+static void print(const char * label, int count, size_t bytes)
+{
+    printf("%-18s %5d entries  %8zu KB  %6zu bytes per entry\n", label,
+           count, bytes / 1024, count ? bytes / count : 0);
+}
+
+int main()
+{
+    auto base = makeDesktopTree(entryCount);
+    if (base.isEmpty())
+        return 1;
+
+    // GIO indexes the directories the first time; load once and free
+    // the objects, so that only they are counted below
+    g_list_free_full(g_app_info_get_all(), g_object_unref);
+
+    size_t before = heapInUse();
+    GList * gioApps = g_app_info_get_all();
+    print("GDesktopAppInfo", g_list_length(gioApps), heapInUse() - before);
+    g_list_free_full(gioApps, g_object_unref);
+
+    before = heapInUse();
+    auto scan = std::make_unique<AppScan>();
+    size_t scanBytes = heapInUse() - before;
+
+    // as in Resources::loadAppInfos()
+    std::unordered_map<QString, AppInfo::Data> apps;
+    before = heapInUse();
+    {
+        std::vector<QString> ids;
+        std::vector<QByteArray> paths;
+        for (auto & pair : scan->files())
+        {
+            ids.push_back(pair.first);
+            paths.push_back(pair.second.path);
+        }
+
+        auto appData = readDesktopFiles(paths);
+        for (size_t i = 0; i < ids.size(); i++)
+        {
+            if (appData[i])
+                apps.try_emplace(ids[i], std::move(*appData[i]));
+        }
+    }
+
+    print("AppInfo::Data", apps.size(), heapInUse() - before);
+    print("AppScan files", scan->files().size(), scanBytes);
+
+    removeTree(base);
+    return 0;
+}
@@ -0,0 +1,142 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * qmpanel - a minimal Qt-based desktop panel
+ *
+ * Copyright: 2026 John Lindgren
+ * Authors:
+ *   John Lindgren <john@jlindgren.net>
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+// Times building the map of short application names for 1,000
+// synthetic applications, with the regular expressions the panel used
+// before and with AppNameMap, and counts the allocations of each.
+
+#include "appnamemap.h"
+#include "bench.h"
+
+#include <QRegularExpression>
+
+static const int appCount = 1000;
+static const int runCount = 200;
+
+struct App
+{
+    QString id;
+    AppInfo::Data data;
+};
+
+static std::vector<App> makeApps()
+{
+    NameGenerator names(6);
+    std::vector<App> apps;
+
+    for (int i = 0; i < appCount; i++)
+    {
+        auto brand = names.brand();
+        auto lower = brand.toLower();
+
+        // a mix of reverse-DNS and plain IDs and of program names given
+        // with and without a path, as on a typical system
+        App app;
+        app.id = (i % 3) ? QString("org.%1.%2.desktop")
+                               .arg(names.brand().toLower(), brand)
+                         : lower + ".desktop";
+        app.data.displayName = brand + ' ' + names.name();
+        app.data.executable =
+            (i % 4) ? lower : QString("/usr/lib/%1/%1-bin").arg(lower);
+        if (i % 5 == 0)
+            app.data.startupWMClass = brand;
+
+        apps.push_back(std::move(app));
+    }
+
+    return apps;
+}
+
+// as Resources::makeAppNameMap() did before (without the GIO getters)
+static std::unordered_map<QString, QString>
+buildRegex(const std::vector<App> & apps)
+{
+    static QRegularExpression desktopExtRegEx("\\.desktop$");
+    static QRegularExpression beforeDotRegEx(".*\\.");
+    static QRegularExpression beforeSlashRegEx(".*\\/");
+
+    std::unordered_map<QString, QString> nameMap;
+    for (auto & app : apps)
+    {
+        QString name = app.id;
+        name.remove(desktopExtRegEx);
+        name.remove(beforeDotRegEx);
+        nameMap.emplace(name.toLower(), app.id);
+
+        QString execName = app.data.executable;
+        execName.remove(beforeSlashRegEx);
+        if (!execName.isEmpty())
+            nameMap.emplace(execName.toLower(), app.id);
+
+        QString wmClass = app.data.startupWMClass;
+        if (!wmClass.isEmpty())
+            nameMap.emplace(wmClass.toLower(), app.id);
+    }
+
+    return nameMap;
+}
+
+static AppNameMap buildInterned(const std::vector<App> & apps)
+{
+    AppNameMap nameMap;
+    for (auto & app : apps)
+        nameMap.add(app.id, app.data);
+
+    return nameMap;
+}
+
+// times exclude freeing the map
+template<typename Build>
+static void run(const char * label, const std::vector<App> & apps,
+                Build build)
+{
+    std::vector<double> times;
+    long allocs = 0;
+
+    for (int i = 0; i < runCount; i++)
+    {
+        long before = allocCount;
+        auto start = BenchClock::now();
+        auto nameMap = build(apps);
+        times.push_back(msSince(start));
+        allocs = allocCount - before;
+    }
+
+    printf("%-10s  median %7.3f ms  p99 %7.3f ms  %6ld allocations\n",
+           label, percentile(times, 0.5), percentile(times, 0.99), allocs);
+}
+
+int main()
+{
+    auto apps = makeApps();
+    printf("name map for %d applications, %d runs each\n", appCount,
+           runCount);
+
+    run("regex", apps, buildRegex);
+    run("interned", apps, buildInterned);
+
+    return 0;
+}
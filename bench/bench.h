@@ -0,0 +1,175 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * qmpanel - a minimal Qt-based desktop panel
+ *
+ * Copyright: 2026 John Lindgren
+ * Authors:
+ *   John Lindgren <john@jlindgren.net>
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <QString>
+#include <QStringList>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iterator>
+#include <random>
+#include <stdio.h>
+#include <vector>
+
+// Helpers shared by the benchmarks (run by "meson test --benchmark").
+// Nothing here is part of the panel itself.
+
+using BenchClock = std::chrono::steady_clock;
+
+// calls to malloc(), calloc() and realloc() so far, counted only in
+// benchmarks that link alloccount.cpp
+extern std::atomic<long> allocCount;
+
+static inline double msSince(BenchClock::time_point start)
+{
+    std::chrono::duration<double, std::milli> elapsed =
+        BenchClock::now() - start;
+    return elapsed.count();
+}
+
+// value at the given fraction (0 to 1) of the sorted samples
+static inline double percentile(std::vector<double> samples, double at)
+{
+    if (samples.empty())
+        return 0;
+
+    std::sort(samples.begin(), samples.end());
+    size_t idx = at * (samples.size() - 1) + 0.5;
+    return samples[idx];
+}
+
+// Generates application names whose words are distributed roughly as in
+// real menus: a few descriptive words ("Settings", "Viewer") occur in
+// many names, while most brand names ("Kalvenor") occur only once.
+class NameGenerator
+{
+public:
+    explicit NameGenerator(unsigned seed) : mRandom(seed)
+    {
+        std::vector<double> weights;
+        for (size_t i = 0; i < std::size(commonWords); i++)
+            weights.push_back(1.0 / (i + 1));
+
+        mZipf = std::discrete_distribution<int>(weights.begin(),
+                                                weights.end());
+    }
+
+    // e.g. "Kalvenor", "Kalvenor Image Viewer" or "Disk Usage Manager"
+    QString name()
+    {
+        QStringList words;
+        int kind = pick(10);
+        if (kind < 7)
+            words.append(brand());
+        if (kind >= 4)
+        {
+            for (int count = 1 + pick(3); count > 0; count--)
+                words.append(commonWords[mZipf(mRandom)]);
+        }
+
+        return words.join(' ');
+    }
+
+    // a made-up word of two to four syllables
+    QString brand()
+    {
+        static const char * const syllables[] = {
+            "ka", "vel", "no", "ri", "tam", "zu", "mor", "lin", "ex", "qui",
+            "dra", "pho", "sen", "tu", "bre", "gal", "ko", "nix", "ar", "do"};
+
+        QString word;
+        for (int count = 2 + pick(3); count > 0; count--)
+            word += syllables[pick(std::size(syllables))];
+
+        word[0] = word[0].toUpper();
+        return word;
+    }
+
+    int pick(int n)
+    {
+        return std::uniform_int_distribution<int>(0, n - 1)(mRandom);
+    }
+
+private:
+    // most frequent first
+    static constexpr const char * commonWords[] = {
+        "Settings", "Manager",  "Editor",   "Viewer",    "Player",
+        "Terminal", "Monitor",  "Browser",  "Image",     "Text",
+        "System",   "File",     "Sound",    "Video",     "Network",
+        "Disk",     "Document", "Music",    "Photo",     "Mail",
+        "Calendar", "Archive",  "Screen",   "Font",      "Color",
+        "Office",   "Print",    "Remote",   "Backup",    "Package",
+        "Power",    "Input",    "Map",      "Clock",     "Calculator",
+        "Chat",     "Notes",    "Scanner",  "Camera",    "Weather",
+        "Usage",    "Analyzer", "Recorder", "Converter", "Tool"};
+
+    std::mt19937 mRandom;
+    std::discrete_distribution<int> mZipf;
+};
+
+// Search strings as typed one key at a time: the first few letters of
+// one or more words of names from the corpus, each name followed by an
+// empty string (the search being cleared)
+static inline std::vector<QString>
+typingSequence(const std::vector<QString> & corpus, int count, unsigned seed)
+{
+    std::mt19937 random(seed);
+    std::vector<QString> typed;
+
+    for (int i = 0; i < count; i++)
+    {
+        QString query;
+        auto words = corpus[random() % corpus.size()].split(' ');
+        for (auto & word : words)
+        {
+            if (!query.isEmpty())
+            {
+                query += ' ';
+                typed.push_back(query);
+            }
+
+            int len = 1 + random() % std::min<int>(word.size(), 5);
+            for (int j = 0; j < len; j++)
+            {
+                query += word[j].toLower();
+                typed.push_back(query);
+            }
+
+            // often one word is enough
+            if (random() % 2)
+                break;
+        }
+
+        typed.push_back(QString());
+    }
+
+    return typed;
+}
+
+#endif
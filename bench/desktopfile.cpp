@@ -0,0 +1,109 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * qmpanel - a minimal Qt-based desktop panel
+ *
+ * Copyright: 2026 John Lindgren
+ * Authors:
+ *   John Lindgren <john@jlindgren.net>
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+// Compares reading a synthetic tree of .desktop files with the native
+// parser (as the panel does at startup without a cache) against
+// g_app_info_get_all(), which the panel used before.
+
+#include "appscan.h"
+#include "bench.h"
+#include "desktopfile.h"
+#include "desktoptree.h"
+
+#include <gio/gio.h>
+
+static const int entryCount = 5000;
+static const int runCount = 5;
+
+static int readNative()
+{
+    AppScan scan;
+    std::vector<QByteArray> paths;
+    for (auto & pair : scan.files())
+        paths.push_back(pair.second.path);
+
+    int count = 0;
+    for (auto & data : readDesktopFiles(paths))
+        count += (bool)data;
+
+    return count;
+}
+
+// the same, but in one thread
+static int readNativeSerial()
+{
+    AppScan scan;
+    int count = 0;
+    for (auto & pair : scan.files())
+    {
+        AppInfo::Data data;
+        count += readDesktopFile(pair.second.path, data);
+    }
+
+    return count;
+}
+
+static int readGIO()
+{
+    GList * apps = g_app_info_get_all();
+    int count = g_list_length(apps);
+    g_list_free_full(apps, g_object_unref);
+    return count;
+}
+
+// The first run includes GIO's one-time indexing of the directories.
+// All runs read from the page cache, since the tree was just written.
+static void run(const char * label, int (*read)())
+{
+    std::vector<double> times;
+    int count = 0;
+    for (int i = 0; i < runCount; i++)
+    {
+        auto start = BenchClock::now();
+        count = read();
+        times.push_back(msSince(start));
+    }
+
+    printf("%-16s %5d entries  first %8.1f ms  median %8.1f ms\n", label,
+           count, times[0], percentile(times, 0.5));
+}
+
+int main()
+{
+    auto base = makeDesktopTree(entryCount);
+    if (base.isEmpty())
+        return 1;
+
+    printf("%d synthetic .desktop files, %d runs each\n", entryCount,
+           runCount);
+
+    run("native", readNative);
+    run("native, serial", readNativeSerial);
+    run("GIO", readGIO);
+
+    removeTree(base);
+    return 0;
+}
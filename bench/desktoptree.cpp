@@ -0,0 +1,118 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * qmpanel - a minimal Qt-based desktop panel
+ *
+ * Copyright: 2026 John Lindgren
+ * Authors:
+ *   John Lindgren <john@jlindgren.net>
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "desktoptree.h"
+#include "bench.h"
+#include "utils.h"
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+// real .desktop files are usually translated into dozens of languages
+static const char * const locales[] = {
+    "ar", "ca", "cs", "da", "de", "el", "es", "fi", "fr", "hu",
+    "it", "ja", "ko", "nl", "pl", "pt_BR", "ru", "sv", "tr", "zh_CN"};
+
+static const char * const categories[] = {
+    "Development;IDE;", "Education;Science;", "Game;ArcadeGame;",
+    "Graphics;2DGraphics;", "AudioVideo;Player;", "Network;WebBrowser;",
+    "Office;WordProcessor;", "Settings;DesktopSettings;", "System;Monitor;",
+    "Utility;TextEditor;"};
+
+// as in /usr/share/applications, most files are at the top level
+static const char * const subdirs[] = {"", "", "", "kde4/", "wine/"};
+
+static void addLocalized(QByteArray & text, const char * key,
+                         const QByteArray & value)
+{
+    text += QByteArray(key) + '=' + value + '\n';
+    for (auto locale : locales)
+        text += QByteArray(key) + '[' + locale + "]=" + value + " (" +
+                locale + ")\n";
+}
+
+static void writeTree(const QByteArray & dir, int count)
+{
+    for (auto sub : subdirs)
+        g_mkdir_with_parents(dir + "/applications/" + sub, 0755);
+
+    NameGenerator names(4);
+    for (int i = 0; i < count; i++)
+    {
+        auto num = QByteArray::number(i);
+        auto name = names.name().toUtf8();
+
+        QByteArray text = "[Desktop Entry]\nType=Application\n";
+        addLocalized(text, "Name", name);
+        addLocalized(text, "GenericName", names.name().toUtf8());
+        addLocalized(text, "Comment", "Use " + name + " on your desktop");
+        text += "Keywords=" + names.brand().toUtf8() + ';' +
+                names.brand().toUtf8() + ";\n";
+        text += "Icon=bench-app-" + num + '\n';
+        // GIO hides entries whose programs are not installed
+        text += "Exec=true --bench-app-" + num + " %U\n";
+        text += QByteArray("Categories=") +
+                categories[i % std::size(categories)] + '\n';
+        if (i % 10 == 0)
+            text += "StartupWMClass=bench-app-" + num + '\n';
+        if (i % 50 == 0)
+            text += "NoDisplay=true\n";
+
+        text += "\n[Desktop Action new-window]\n";
+        addLocalized(text, "Name", "New Window");
+        text += "Exec=true --bench-app-" + num + " --new-window\n";
+
+        auto path = dir + "/applications/" + subdirs[i % std::size(subdirs)] +
+                    "bench-app-" + num + ".desktop";
+        g_file_set_contents(path, text.constData(), text.size(), nullptr);
+    }
+}
+
+QByteArray makeDesktopTree(int count)
+{
+    CharPtr dir(g_dir_make_tmp("qmpanel-bench-XXXXXX", nullptr), g_free);
+    if (!dir)
+        return QByteArray();
+
+    QByteArray base(dir.get());
+    g_setenv("XDG_DATA_HOME", base + "/home", true);
+    g_setenv("XDG_DATA_DIRS", base, true);
+
+    writeTree(base, count);
+    return base;
+}
+
+void removeTree(const QByteArray & path)
+{
+    AutoPtr<GDir> dir(g_dir_open(path, 0, nullptr), g_dir_close);
+    if (dir)
+    {
+        while (auto name = g_dir_read_name(dir.get()))
+            removeTree(path + '/' + name);
+    }
+
+    g_remove(path);
+}
@@ -0,0 +1,41 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * qmpanel - a minimal Qt-based desktop panel
+ *
+ * Copyright: 2026 John Lindgren
+ * Authors:
+ *   John Lindgren <john@jlindgren.net>
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef DESKTOPTREE_H
+#define DESKTOPTREE_H
+
+#include <QByteArray>
+
+// Writes a synthetic tree of translated .desktop files in a new
+// temporary directory and points $XDG_DATA_DIRS (and $XDG_DATA_HOME) at
+// it. Call before anything else reads those variables. Returns the
+// directory, or an empty string on error.
+QByteArray makeDesktopTree(int count);
+
+// deletes a directory and everything in it
+void removeTree(const QByteArray & path);
+
+#endif
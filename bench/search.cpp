@@ -0,0 +1,166 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * qmpanel - a minimal Qt-based desktop panel
+ *
+ * Copyright: 2026 John Lindgren
+ * Authors:
+ *   John Lindgren <john@jlindgren.net>
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+// Replays typed searches through the main menu's search (SearchIndex,
+// ActionModel and ActionView) for synthetic corpora of 1,000, 10,000
+// and 50,000 applications, under the offscreen platform plugin. For
+// each keystroke, reports the time until the model has the results and
+// until the view has been measured and painted, and the allocations
+// made meanwhile (in all threads).
+
+#include "actionmodel.h"
+#include "actionview.h"
+#include "bench.h"
+#include "searchindex.h"
+
+#include <QApplication>
+
+static const int corpusSizes[] = {1000, 10000, 50000};
+static const int queryCount = 200;
+
+struct Corpus
+{
+    std::vector<QString> ids, names;
+    std::shared_ptr<const SearchIndex> index;
+};
+
+static Corpus makeCorpus(int size)
+{
+    NameGenerator names(size);
+    auto index = std::make_shared<SearchIndex>();
+    Corpus corpus;
+
+    for (int i = 0; i < size; i++)
+    {
+        AppInfo::Data data;
+        data.displayName = names.name();
+        data.genericName = names.name();
+        data.keywords = names.brand() + ';' + names.brand() + ';';
+        data.comment = "Use " + data.displayName + " on your desktop";
+        data.executable = data.displayName.section(' ', 0, 0).toLower();
+
+        auto id = QString("org.bench.App%1.desktop").arg(i);
+        index->add(id, data);
+        corpus.ids.push_back(id);
+        corpus.names.push_back(data.displayName);
+    }
+
+    corpus.index = std::move(index);
+    return corpus;
+}
+
+struct Samples
+{
+    std::vector<double> times, allocs;
+};
+
+static void print(const char * label, const Samples & samples)
+{
+    printf("  %-6s p50 %8.3f ms  p99 %8.3f ms  "
+           "allocations p50 %6.0f  p99 %6.0f\n",
+           label, percentile(samples.times, 0.5),
+           percentile(samples.times, 0.99), percentile(samples.allocs, 0.5),
+           percentile(samples.allocs, 0.99));
+}
+
+// Each key is typed only after the results of the last are shown, so no
+// search is dropped as stale. Clearing the search is not timed.
+template<typename Type>
+static Samples replay(const std::vector<QString> & typed, bool & shown,
+                      Type type)
+{
+    Samples samples;
+    for (auto & str : typed)
+    {
+        long before = allocCount;
+        auto start = BenchClock::now();
+
+        shown = false;
+        type(str);
+        while (!shown)
+            QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+
+        if (!str.isEmpty())
+        {
+            samples.times.push_back(msSince(start));
+            samples.allocs.push_back(allocCount - before);
+        }
+    }
+
+    return samples;
+}
+
+int main(int argc, char * argv[])
+{
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+
+    // the icon is requested only for rows painted
+    QAction action;
+    auto getAction = [&action]() { return &action; };
+
+    for (int size : corpusSizes)
+    {
+        auto corpus = makeCorpus(size);
+        auto typed = typingSequence(corpus.names, queryCount, 1);
+        bool shown = false;
+
+        ActionModel model;
+        model.setSearchIndex(corpus.index);
+        model.setResultsChanged([&shown]() { shown = true; });
+
+        ActionView view;
+        view.setSearchIndex(corpus.index);
+        // measured and painted as when the main menu shows the results
+        view.setResultsChanged([&view, &shown]() {
+            view.sizeHint();
+            view.viewport()->repaint();
+            shown = true;
+        });
+        view.resize(400, 300);
+        view.show();
+
+        for (int i = 0; i < size; i++)
+        {
+            model.addItem(corpus.ids[i], corpus.names[i], getAction);
+            view.addItem(corpus.ids[i], corpus.names[i], getAction);
+        }
+
+        auto modelSamples = replay(typed, shown, [&](const QString & str) {
+            model.setSearchStr(str);
+        });
+
+        auto viewSamples = replay(typed, shown, [&](const QString & str) {
+            view.setSearchStr(str);
+        });
+
+        printf("%d items, %zu keystrokes\n", size, modelSamples.times.size());
+        print("model", modelSamples);
+        print("view", viewSamples);
+    }
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * qmpanel - a minimal Qt-based desktop panel
+ *
+ * Copyright: 2026 John Lindgren
+ * Authors:
+ *   John Lindgren <john@jlindgren.net>
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+// Times matching every item against the search after each keystroke, as
+// a search that cannot narrow the last one does, for 10,000 synthetic
+// application names. Reports the cost per keystroke and its allocations.
+
+#include "bench.h"
+#include "stringfilter.h"
+
+static const int itemCount = 10000;
+static const int queryCount = 500;
+
+int main()
+{
+    NameGenerator names(14);
+    std::vector<QString> corpus, folded;
+    std::vector<uint64_t> masks;
+
+    for (int i = 0; i < itemCount; i++)
+    {
+        corpus.push_back(names.name());
+        folded.push_back(corpus.back().toCaseFolded());
+        masks.push_back(charMask(folded.back()));
+    }
+
+    StringFilter filter;
+    std::vector<int> scores(itemCount);
+    std::vector<double> times, allocs;
+    size_t matched = 0;
+
+    for (auto & str : typingSequence(corpus, queryCount, 1))
+    {
+        if (str.isEmpty())
+            continue;
+
+        long before = allocCount;
+        auto start = BenchClock::now();
+
+        // as in ActionModel::search() (without the search index)
+        filter.setSearchStr(str);
+        uint64_t mask = filter.charMask();
+        for (int i = 0; i < itemCount; i++)
+        {
+            scores[i] =
+                (mask & ~masks[i]) ? -1 : filter.score(folded[i], -1);
+            matched += (scores[i] >= 0);
+        }
+
+        times.push_back(msSince(start));
+        allocs.push_back(allocCount - before);
+    }
+
+    printf("%d items, %zu keystrokes, %.1f matches per keystroke\n",
+           itemCount, times.size(), (double)matched / times.size());
+    printf("time per keystroke: p50 %.3f ms, p99 %.3f ms, max %.3f ms\n",
+           percentile(times, 0.5), percentile(times, 0.99),
+           percentile(times, 1));
+    printf("allocations per keystroke: p50 %.0f, max %.0f\n",
+           percentile(allocs, 0.5), percentile(allocs, 1));
+
+    return 0;
+}
@@ -0,0 +1,425 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * qmpanel - a minimal Qt-based desktop panel
+ *
+ * Copyright: 2026 John Lindgren
+ * Authors:
+ *   John Lindgren <john@jlindgren.net>
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "actionmodel.h"
+
+#include <algorithm>
+
+// no results can be queued after this
+ActionModel::~ActionModel()
+{
+    if (mThread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mQuit = true;
+        }
+
+        mWake.notify_one();
+        mThread.join();
+    }
+
+    for (auto & item : mItems)
+        QObject::disconnect(item.changed);
+}
+
+void ActionModel::setSearchIndex(std::shared_ptr<const SearchIndex> index)
+{
+    mIndex = std::move(index);
+
+    // Search again, since the index matches (also used to score items
+    // added from now on) are from the old index. Otherwise applications
+    // just added would not be found by their other fields.
+    QString str = mFilter.searchStr();
+    if (!str.isEmpty())
+        setSearchStr(str);
+}
+
+void ActionModel::addItem(const QString & id, const QString & text,
+                          ActionView::ActionGetter getAction)
+{
+    int idx = mItems.size();
+    auto folded = text.toCaseFolded();
+    uint64_t mask = charMask(folded);
+
+    mItems.push_back({id, text, folded, mask, std::move(getAction)});
+
+    int itemScore = score(idx);
+    if (itemScore < 0)
+        return;
+
+    setScore(idx, itemScore);
+
+    auto less = [this](int a, int b) { return lessThan(a, b); };
+    auto pos = std::upper_bound(mResults.begin(), mResults.end(), idx, less);
+    int row = pos - mResults.begin();
+
+    beginInsertRows(QModelIndex(), row, row);
+    mResults.insert(pos, idx);
+    endInsertRows();
+}
+
+void ActionModel::removeItems(const QStringList & ids)
+{
+    std::vector<int> newIdx(mItems.size(), -1);
+    size_t count = 0;
+
+    for (size_t idx = 0; idx < mItems.size(); idx++)
+    {
+        if (ids.contains(mItems[idx].id))
+        {
+            QObject::disconnect(mItems[idx].changed);
+            continue;
+        }
+
+        if (count != idx)
+            mItems[count] = std::move(mItems[idx]);
+
+        newIdx[idx] = count++;
+    }
+
+    if (count == mItems.size())
+        return;
+
+    beginResetModel();
+
+    mItems.resize(count);
+    mSnapshot.reset();
+
+    size_t rows = 0;
+    for (int idx : mResults)
+    {
+        if (newIdx[idx] >= 0)
+            mResults[rows++] = newIdx[idx];
+    }
+
+    mResults.resize(rows);
+    endResetModel();
+
+    // search again, since a pending search has the old indexes
+    QString str = mFilter.searchStr();
+    if (!str.isEmpty())
+        setSearchStr(str);
+}
+
+void ActionModel::setItemText(const QString & id, const QString & text)
+{
+    auto hasID = [&id](const Item & item) { return item.id == id; };
+    auto item = std::find_if(mItems.begin(), mItems.end(), hasID);
+    if (item == mItems.end() || item->text == text)
+        return;
+
+    item->text = text;
+    item->folded = text.toCaseFolded();
+    item->charMask = charMask(item->folded);
+    item->width = -1;
+    mSnapshot.reset();
+
+    // search again, since the item may now match differently
+    QString str = mFilter.searchStr();
+    if (!str.isEmpty())
+        setSearchStr(str);
+}
+
+void ActionModel::setSearchStr(const QString & str)
+{
+    int generation = ++mGeneration;
+
+    mFilter.setSearchStr(str);
+    auto & searchStr = mFilter.searchStr(); // without surrounding spaces
+
+    if (searchStr.isEmpty())
+    {
+        beginResetModel();
+        mResults.clear();
+        endResetModel();
+
+        mIndexMatches.clear();
+
+        mLastSnapshot.reset();
+        mLastStr.clear();
+        mLastScores.clear();
+        mShownGeneration = generation;
+
+        if (mResultsChanged)
+            mResultsChanged();
+
+        return;
+    }
+
+    if (!mSnapshot || mSnapshot->ids.size() != mItems.size())
+    {
+        auto snapshot = std::make_shared<SearchSnapshot>();
+        for (auto & item : mItems)
+        {
+            snapshot->ids.push_back(item.id);
+            snapshot->folded.push_back(item.folded);
+            snapshot->charMasks.push_back(item.charMask);
+        }
+
+        mSnapshot = std::move(snapshot);
+    }
+
+    auto job = std::make_unique<SearchJob>();
+    job->generation = generation;
+    job->snapshot = mSnapshot;
+    job->filter = mFilter;
+    job->index = mIndex;
+
+    if (mLastSnapshot == mSnapshot && !mLastStr.isEmpty() &&
+        searchStr.startsWith(mLastStr))
+        job->lastScores = mLastScores;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mJob = std::move(job); // replaces any not yet started
+    }
+
+    if (mThread.joinable())
+        mWake.notify_one();
+    else
+        mThread = std::thread([this]() { run(); });
+}
+
+void ActionModel::trigger(int row) const
+{
+    auto action = mItems[mResults[row]].getAction();
+    if (action)
+        action->trigger();
+}
+
+void ActionModel::forgetWidths()
+{
+    for (auto & item : mItems)
+        item.width = -1;
+}
+
+QVariant ActionModel::data(const QModelIndex & index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount())
+        return QVariant();
+
+    auto & item = mItems[mResults[index.row()]];
+    if (role == Qt::DisplayRole)
+        return item.text;
+    if (role == Qt::DecorationRole)
+        return getIcon(item);
+
+    return QVariant();
+}
+
+QIcon ActionModel::getIcon(const Item & item) const
+{
+    auto action = item.getAction();
+    if (!action)
+        return QIcon();
+
+    // repaint when the icon is set (it may be rendered later)
+    if (action != item.action)
+    {
+        auto self = const_cast<ActionModel *>(this);
+        auto changed = [self, action]() { self->iconChanged(action); };
+        QObject::disconnect(item.changed);
+        item.action = action;
+        item.changed = QObject::connect(action, &QAction::changed, changed);
+    }
+
+    return action->icon();
+}
+
+void ActionModel::iconChanged(QAction * action)
+{
+    for (size_t row = 0; row < mResults.size(); row++)
+    {
+        if (mItems[mResults[row]].action == action)
+        {
+            auto idx = index(row);
+            emit dataChanged(idx, idx, {Qt::DecorationRole});
+        }
+    }
+}
+
+// matches a single item against the current search on the GUI thread
+int ActionModel::score(int idx) const
+{
+    if (mFilter.searchStr().isEmpty())
+        return -1;
+
+    auto & item = mItems[idx];
+    auto found = mIndexMatches.find(item.id);
+    int fields = (found != mIndexMatches.end()) ? found->second : -1;
+
+    return mFilter.score(item.folded, fields);
+}
+
+void ActionModel::setScore(int idx, int score)
+{
+    auto & item = mItems[idx];
+    item.score = score;
+    item.rank = mRank ? mRank(item.id) : 0;
+}
+
+bool ActionModel::lessThan(int a, int b) const
+{
+    auto & left = mItems[a];
+    auto & right = mItems[b];
+
+    if (left.rank != right.rank)
+        return left.rank > right.rank;
+    if (left.score != right.score)
+        return left.score > right.score;
+
+    return left.text.compare(right.text, Qt::CaseInsensitive) < 0;
+}
+
+void ActionModel::run()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    while (true)
+    {
+        mWake.wait(lock, [this]() { return mQuit || mJob; });
+        if (mQuit)
+            return;
+
+        auto job = std::move(mJob);
+        lock.unlock();
+
+        auto scores = std::make_shared<std::vector<int>>();
+        auto matches = std::make_shared<SearchIndex::Matches>();
+        if (search(*job, *scores, *matches))
+        {
+            auto apply = [this, generation = job->generation,
+                          snapshot = job->snapshot, scores, matches]() {
+                applyResults(generation, snapshot, std::move(*scores),
+                             std::move(*matches));
+            };
+
+            QMetaObject::invokeMethod(this, apply, Qt::QueuedConnection);
+        }
+
+        lock.lock();
+    }
+}
+
+// Called from the worker thread; returns false if another search has
+// started meanwhile. The search index is queried here too (the job holds
+// the index, which is replaced rather than modified when applications
+// change). Index matches may lack characters of the search (in another
+// field), so are checked first.
+//
+// If narrowing the last search, only the items matched then are checked
+// again. Before that, a single pass over the character masks of all
+// items (contiguous, so that the compiler can vectorize it) rules out
+// items lacking any character of the search.
+bool ActionModel::search(const SearchJob & job, std::vector<int> & scores,
+                         SearchIndex::Matches & indexMatches) const
+{
+    auto & snapshot = *job.snapshot;
+    size_t count = snapshot.ids.size();
+
+    if (job.index)
+        indexMatches = job.index->find(job.filter.searchStr());
+    if (job.generation != mGeneration)
+        return false;
+
+    std::vector<uint8_t> matched(count, 1);
+    if (job.lastScores.size() == count)
+    {
+        for (size_t idx = 0; idx < count; idx++)
+            matched[idx] = (job.lastScores[idx] >= 0);
+    }
+
+    uint64_t mask = job.filter.charMask();
+    auto masks = snapshot.charMasks.data();
+    auto pMatched = matched.data();
+    for (size_t idx = 0; idx < count; idx++)
+        pMatched[idx] &= !(mask & ~masks[idx]);
+
+    scores.assign(count, -1);
+    for (size_t idx = 0; idx < count; idx++)
+    {
+        if (idx % 64 == 0 && job.generation != mGeneration)
+            return false;
+
+        auto found = indexMatches.find(snapshot.ids[idx]);
+        int fields = (found != indexMatches.end()) ? found->second : -1;
+        if (fields < 0 && !matched[idx])
+            continue;
+
+        scores[idx] = job.filter.score(snapshot.folded[idx], fields);
+    }
+
+    return true;
+}
+
+void ActionModel::applyResults(int generation,
+                               std::shared_ptr<const SearchSnapshot> snapshot,
+                               std::vector<int> && scores,
+                               SearchIndex::Matches && indexMatches)
+{
+    if (generation != mGeneration)
+        return;
+
+    // also used for items added from now on
+    mIndexMatches = std::move(indexMatches);
+
+    beginResetModel();
+    mResults.clear();
+
+    for (size_t idx = 0; idx < scores.size(); idx++)
+    {
+        if (scores[idx] >= 0)
+        {
+            setScore(idx, scores[idx]);
+            mResults.push_back(idx);
+        }
+    }
+
+    // items added since the search started
+    for (size_t idx = scores.size(); idx < mItems.size(); idx++)
+    {
+        int itemScore = score(idx);
+        if (itemScore >= 0)
+        {
+            setScore(idx, itemScore);
+            mResults.push_back(idx);
+        }
+    }
+
+    auto less = [this](int a, int b) { return lessThan(a, b); };
+    std::sort(mResults.begin(), mResults.end(), less);
+
+    endResetModel();
+
+    mLastSnapshot = std::move(snapshot);
+    mLastStr = mFilter.searchStr();
+    mLastScores = std::move(scores);
+    mShownGeneration = generation;
+
+    if (mResultsChanged)
+        mResultsChanged();
+}
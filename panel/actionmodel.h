@@ -0,0 +1,168 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * qmpanel - a minimal Qt-based desktop panel
+ *
+ * Copyright: 2026 John Lindgren
+ * Authors:
+ *   John Lindgren <john@jlindgren.net>
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef ACTIONMODEL_H
+#define ACTIONMODEL_H
+
+#include "actionview.h"
+#include "searchindex.h"
+#include "stringfilter.h"
+
+#include <QAbstractListModel>
+#include <QAction>
+#include <QPointer>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// What a search needs to know about the items, copied so that it can be
+// read by the worker thread while items are added on the GUI thread
+struct SearchSnapshot
+{
+    std::vector<QString> ids;
+    std::vector<QString> folded;
+    std::vector<uint64_t> charMasks;
+};
+
+struct SearchJob
+{
+    int generation;
+    std::shared_ptr<const SearchSnapshot> snapshot;
+    StringFilter filter;
+    std::shared_ptr<const SearchIndex> index;
+    // scores from the last search, if the new one only appends to it
+    std::vector<int> lastScores;
+};
+
+// Used only by ActionView (and the search benchmark).
+//
+// Holds all items in one vector and the results of the current search in
+// another (as indexes into the first, in sorted order), so that a search
+// rebuilds only the second and resets the model once.
+//
+// Searches run in a worker thread. Each one increments a generation
+// counter, and results are dropped if another search has started since,
+// so only the latest are shown. Items added while a search runs are
+// matched on the GUI thread when the results arrive.
+class ActionModel : public QAbstractListModel
+{
+public:
+    using QAbstractListModel::QAbstractListModel;
+    ~ActionModel();
+
+    void setSearchIndex(std::shared_ptr<const SearchIndex> index);
+    void setRanking(ActionView::Ranking rank) { mRank = std::move(rank); }
+    void setResultsChanged(std::function<void()> callback)
+    {
+        mResultsChanged = std::move(callback);
+    }
+
+    void addItem(const QString & id, const QString & text,
+                 ActionView::ActionGetter getAction);
+    void removeItems(const QStringList & ids);
+    void setItemText(const QString & id, const QString & text);
+    void setSearchStr(const QString & str);
+    void trigger(int row) const;
+
+    // true from the start of a search until its results are shown
+    bool searchPending() const { return mShownGeneration != mGeneration; }
+
+    const QString & text(int row) const { return mItems[mResults[row]].text; }
+    // width of a row as measured by the view (-1 if not yet measured)
+    int width(int row) const { return mItems[mResults[row]].width; }
+    void setWidth(int row, int width) const
+    {
+        mItems[mResults[row]].width = width;
+    }
+    void forgetWidths();
+
+    int rowCount(const QModelIndex & parent = QModelIndex()) const override
+    {
+        return parent.isValid() ? 0 : mResults.size();
+    }
+
+    QVariant data(const QModelIndex & index, int role) const override;
+
+private:
+    struct Item
+    {
+        QString id;
+        QString text;
+        QString folded; // case-folded for searching
+        uint64_t charMask;
+        ActionView::ActionGetter getAction;
+        // results of the current search
+        int score = 0;
+        double rank = 0;
+        mutable int width = -1;
+        mutable QPointer<QAction> action;
+        mutable QMetaObject::Connection changed;
+    };
+
+    QIcon getIcon(const Item & item) const;
+    void iconChanged(QAction * action);
+
+    int score(int idx) const;
+    void setScore(int idx, int score);
+    bool lessThan(int a, int b) const;
+
+    void run();
+    bool search(const SearchJob & job, std::vector<int> & scores,
+                SearchIndex::Matches & indexMatches) const;
+    void applyResults(int generation,
+                      std::shared_ptr<const SearchSnapshot> snapshot,
+                      std::vector<int> && scores,
+                      SearchIndex::Matches && indexMatches);
+
+    std::vector<Item> mItems;
+    std::vector<int> mResults;
+
+    StringFilter mFilter;
+    std::shared_ptr<const SearchIndex> mIndex;
+    SearchIndex::Matches mIndexMatches; // of the results shown
+    ActionView::Ranking mRank;
+    std::function<void()> mResultsChanged;
+
+    // rebuilt for the next search after items are added or removed
+    std::shared_ptr<const SearchSnapshot> mSnapshot;
+    // of the results shown, to narrow the next search
+    std::shared_ptr<const SearchSnapshot> mLastSnapshot;
+    QString mLastStr;
+    std::vector<int> mLastScores;
+
+    std::atomic<int> mGeneration{0};
+    int mShownGeneration = 0;
+    std::mutex mMutex;
+    std::condition_variable mWake;
+    std::unique_ptr<SearchJob> mJob; // next to run
+    std::thread mThread;
+    bool mQuit = false;
+};
+
+#endif
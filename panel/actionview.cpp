@@ -27,74 +27,12 @@
  * END_COMMON_COPYRIGHT_HEADER */
 
 #include "actionview.h"
+#include "actionmodel.h"
 
-#include <QMenu>
-#include <QPointer>
+#include <QEvent>
 #include <QProxyStyle>
-#include <QSortFilterProxyModel>
-#include <QStandardItemModel>
 #include <algorithm>
 
-class StringFilter
-{
-public:
-    const QString & searchStr() const { return mSearchStr; }
-
-    void setSearchStr(const QString & str)
-    {
-        mSearchStr = str;
-        mSnippets = str.split(' ', Qt::SkipEmptyParts);
-    }
-
-    bool accepts(const QString & string) const
-    {
-        QStringList words = string.split(' ', Qt::SkipEmptyParts);
-
-        auto snippetNotFound = [&words](const QString & snippet) {
-            auto match = std::find_if(
-                words.begin(), words.end(), [&snippet](const QString & word) {
-                    return word.startsWith(snippet, Qt::CaseInsensitive);
-                });
-            return match == words.end();
-        };
-
-        return std::find_if(mSnippets.begin(), mSnippets.end(),
-                            snippetNotFound) == mSnippets.end();
-    }
-
-private:
-    QString mSearchStr;
-    QStringList mSnippets;
-};
-
-class FilterProxyModel : public QSortFilterProxyModel
-{
-public:
-    using QSortFilterProxyModel::QSortFilterProxyModel;
-
-    void setSearchStr(const QString & str)
-    {
-        mFilter.setSearchStr(str);
-        invalidateFilter();
-    }
-
-protected:
-    bool filterAcceptsRow(int source_row,
-                          const QModelIndex & source_parent) const
-    {
-        if (mFilter.searchStr().isEmpty())
-            return true;
-
-        auto srcModel = sourceModel();
-        auto index = srcModel->index(source_row, 0, source_parent);
-        auto text = srcModel->data(index).toString();
-        return mFilter.accepts(text);
-    }
-
-private:
-    StringFilter mFilter;
-};
-
 class SingleActivateStyle : public QProxyStyle
 {
 public:
@@ -109,28 +47,8 @@ public:
     }
 };
 
-class ActionItem : public QStandardItem
-{
-public:
-    ActionItem(QAction * action) : mAction(action)
-    {
-        setIcon(action->icon());
-        setText(action->text());
-    }
-
-    void trigger()
-    {
-        if (mAction)
-            mAction->trigger();
-    }
-
-private:
-    QPointer<QAction> mAction;
-};
-
 ActionView::ActionView(QWidget * parent)
-    : QListView(parent), mModel(new QStandardItemModel(this)),
-      mProxy(new FilterProxyModel(this))
+    : QListView(parent), mModel(new ActionModel(this))
 {
     setEditTriggers(QAbstractItemView::NoEditTriggers);
     setFrameStyle(QFrame::NoFrame);
@@ -138,52 +56,145 @@ ActionView::ActionView(QWidget * parent)
     setSizeAdjustPolicy(AdjustToContents);
     setSelectionBehavior(SelectRows);
     setSelectionMode(SingleSelection);
+    setUniformItemSizes(true);
 
     SingleActivateStyle * s = new SingleActivateStyle;
     s->setParent(this);
     setStyle(s);
 
-    mProxy->setSourceModel(mModel);
-    mProxy->sort(0);
-    setModel(mProxy);
+    setModel(mModel);
+
+    mModel->setResultsChanged([this]() {
+        if (mModel->rowCount() > 0)
+            setCurrentIndex(mModel->index(0, 0));
+        if (mResultsChanged)
+            mResultsChanged();
+
+        if (mActivatePending)
+        {
+            mActivatePending = false;
+            activateCurrent();
+        }
+    });
+
+    auto forgetWidth = [this]() { mColumnWidth = -1; };
+    connect(mModel, &QAbstractItemModel::rowsInserted, this, forgetWidth);
+    connect(mModel, &QAbstractItemModel::rowsRemoved, this, forgetWidth);
+    connect(mModel, &QAbstractItemModel::modelReset, this, forgetWidth);
 
     connect(this, &QAbstractItemView::activated, this,
             &ActionView::onActivated);
 }
 
+void ActionView::setSearchIndex(std::shared_ptr<const SearchIndex> index)
+{
+    mModel->setSearchIndex(std::move(index));
+}
+
+void ActionView::setRanking(Ranking rank)
+{
+    mModel->setRanking(std::move(rank));
+}
+
+void ActionView::setResultsChanged(std::function<void()> callback)
+{
+    mResultsChanged = std::move(callback);
+}
+
 void ActionView::setSearchStr(const QString & str)
 {
-    mProxy->setSearchStr(str);
-    if (mProxy->rowCount() > 0)
-        setCurrentIndex(mProxy->index(0, 0));
+    mModel->setSearchStr(str);
 }
 
+// While a search is running, the results shown are for an earlier
+// search string, so activation waits until the new ones are shown.
 void ActionView::activateCurrent()
 {
+    if (mModel->searchPending())
+    {
+        mActivatePending = true;
+        return;
+    }
+
     QModelIndex const index = currentIndex();
     if (index.isValid())
         emit activated(index);
 }
 
+void ActionView::changeEvent(QEvent * e)
+{
+    if (e->type() == QEvent::FontChange || e->type() == QEvent::StyleChange)
+    {
+        mModel->forgetWidths();
+        mColumnWidth = -1;
+    }
+
+    QListView::changeEvent(e);
+}
+
 QSize ActionView::viewportSizeHint() const
 {
-    int count = mProxy->rowCount();
+    int count = mModel->rowCount();
     if (count == 0)
         return QSize();
 
-    return {sizeHintForColumn(0), sizeHintForRow(0) * std::min(count, 10)};
+    // all rows are the same height, so only the first is measured
+    return {columnWidth(), sizeHintForRow(0) * std::min(count, 10)};
+}
+
+// Like sizeHintForColumn(), but each item is measured only once (and
+// the maximum only once for each search). Only the text is measured,
+// with room for an icon of the fixed size, so that no action is
+// created (by the delegate asking for the icon) just to size the view.
+int ActionView::columnWidth() const
+{
+    if (mColumnWidth >= 0)
+        return mColumnWidth;
+
+    QStyleOptionViewItem option;
+    initViewItemOption(&option);
+    option.features |= QStyleOptionViewItem::HasDisplay |
+                       QStyleOptionViewItem::HasDecoration;
+
+    int width = 0;
+    for (int row = 0; row < mModel->rowCount(); row++)
+    {
+        int itemWidth = mModel->width(row);
+        if (itemWidth < 0)
+        {
+            option.text = mModel->text(row);
+            itemWidth = style()
+                            ->sizeFromContents(QStyle::CT_ItemViewItem,
+                                               &option, QSize(), this)
+                            .width();
+            mModel->setWidth(row, itemWidth);
+        }
+
+        width = std::max(width, itemWidth);
+    }
+
+    mColumnWidth = width;
+    return width;
 }
 
 void ActionView::onActivated(QModelIndex const & index)
 {
-    auto srcIndex = mProxy->mapToSource(index);
-    auto item = static_cast<ActionItem *>(mModel->itemFromIndex(srcIndex));
-    if (item)
-        item->trigger();
+    if (index.isValid())
+        mModel->trigger(index.row());
+}
+
+void ActionView::addItem(const QString & id, const QString & text,
+                         ActionGetter getAction)
+{
+    mModel->addItem(id, text, std::move(getAction));
+}
+
+void ActionView::removeItems(const QStringList & ids)
+{
+    mModel->removeItems(ids);
 }
 
-void ActionView::addActions(QList<QAction *> actions)
+void ActionView::setItemText(const QString & id, const QString & text)
 {
-    for (auto action : actions)
-        mModel->appendRow(new ActionItem(action));
+    mModel->setItemText(id, text);
 }
@@ -30,28 +30,52 @@
 #define ACTION_VIEW_H
 
 #include <QListView>
+#include <functional>
+#include <memory>
 
-class QStandardItemModel;
-class FilterProxyModel;
+class ActionModel;
+class SearchIndex;
 
 class ActionView : public QListView
 {
 public:
     ActionView(QWidget * parent = nullptr);
 
-    void addActions(QList<QAction *> actions);
+    using ActionGetter = std::function<QAction *()>;
+    using Ranking = std::function<double(const QString & id)>;
+
+    // The action (and so its icon) is requested only when the item is
+    // displayed or activated. The ID is used only to remove items.
+    void addItem(const QString & id, const QString & text,
+                 ActionGetter getAction);
+    void removeItems(const QStringList & ids);
+    void setItemText(const QString & id, const QString & text);
+    // Matches words of other fields too (item IDs must be application
+    // IDs). The index is read by the search thread, so must not be
+    // modified; set a new one instead.
+    void setSearchIndex(std::shared_ptr<const SearchIndex> index);
+    // results are sorted by rank first (higher first), then by match
+    void setRanking(Ranking rank);
+    // Results are found in a background thread and shown later, unless
+    // the search is empty or only spaces (then there are none). The
+    // callback is called each time they are shown.
     void setSearchStr(const QString & str);
+    void setResultsChanged(std::function<void()> callback);
     void activateCurrent();
 
 protected:
+    void changeEvent(QEvent * e) override;
     QSize viewportSizeHint() const override;
     QSize minimumSizeHint() const override { return QSize(); }
 
 private:
+    int columnWidth() const;
     void onActivated(QModelIndex const & index);
 
-    QStandardItemModel * mModel;
-    FilterProxyModel * mProxy;
+    ActionModel * mModel;
+    mutable int mColumnWidth = -1; // -1 if not yet measured
+    bool mActivatePending = false; // until the search results are shown
+    std::function<void()> mResultsChanged;
 };
 
 #endif // ACTION_VIEW_H
@@ -0,0 +1,277 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * qmpanel - a minimal Qt-based desktop panel
+ *
+ * Copyright: 2026 John Lindgren
+ * Authors:
+ *   John Lindgren <john@jlindgren.net>
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "appcache.h"
+
+#include <QDebug>
+#include <glib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unordered_map>
+
+// All offsets are relative to the start of the string table, which
+// follows the directory, file and application tables. Strings are UTF-8 and
+// null-terminated. Bump the version whenever the layout (or the order of
+// menuCategories, which categoryMask depends on) changes.
+static const char cacheMagic[8] = {'Q', 'M', 'P', 'A', 'P', 'P', 'S', '\0'};
+static const uint32_t cacheVersion = 5;
+
+struct CacheHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t context;
+    uint32_t dirCount;
+    uint32_t fileCount;
+    uint32_t appCount;
+    uint32_t stringsSize;
+};
+
+struct CacheDir
+{
+    int64_t dev, ino, mtimeSec, mtimeNsec;
+    uint32_t path;
+    uint32_t reserved;
+};
+
+// Files are compared too, since overwriting a .desktop file in place
+// does not change the mtime of its directory
+struct CacheFile
+{
+    int64_t mtimeSec, mtimeNsec;
+    uint32_t id, path;
+};
+
+struct CacheApp
+{
+    uint32_t id, displayName, icon, executable, startupWMClass;
+    uint32_t genericName, keywords, comment;
+    uint32_t categoryMask;
+    uint32_t reserved;
+};
+
+static AppScan::Dir statDir(const QByteArray & path)
+{
+    struct stat st;
+    if (stat(path, &st) < 0 || !S_ISDIR(st.st_mode))
+        return {path, 0, 0, 0, 0};
+
+    return {path, (int64_t)st.st_dev, (int64_t)st.st_ino,
+            (int64_t)st.st_mtim.tv_sec, (int64_t)st.st_mtim.tv_nsec};
+}
+
+AppCache::AppCache(const AppScan & scan)
+    : mDirs(scan.dirs()),
+      mFiles(scan.files()),
+      mPath(QByteArray(g_get_user_cache_dir()) + "/qmpanel/apps.cache")
+{
+    // Localized names and OnlyShowIn/NotShowIn depend on the session
+    mContext = qgetenv("XDG_CURRENT_DESKTOP");
+    for (auto lang = g_get_language_names(); *lang; lang++)
+        mContext += QByteArray(":") + *lang;
+
+    // Applications whose TryExec or Exec program is not found in $PATH
+    // are left out, so the cache also depends on the directories in
+    // $PATH (in order) and is invalidated when a program is installed
+    // or removed in any of them.
+    for (auto & path : qgetenv("PATH").split(':'))
+    {
+        if (!path.isEmpty())
+            mDirs.push_back(statDir(path));
+    }
+}
+
+bool AppCache::read(Resources::AppInfoMap & apps) const
+{
+    AutoPtr<GMappedFile> file(g_mapped_file_new(mPath, false, nullptr),
+                              g_mapped_file_unref);
+    if (!file)
+        return false;
+
+    auto data = g_mapped_file_get_contents(file.get());
+    size_t size = g_mapped_file_get_length(file.get());
+    if (size < sizeof(CacheHeader))
+        return false;
+
+    auto header = (const CacheHeader *)data;
+    if (memcmp(header->magic, cacheMagic, sizeof cacheMagic) ||
+        header->version != cacheVersion)
+        return false;
+
+    size_t tablesSize = sizeof(CacheHeader) +
+                        sizeof(CacheDir) * (size_t)header->dirCount +
+                        sizeof(CacheFile) * (size_t)header->fileCount +
+                        sizeof(CacheApp) * (size_t)header->appCount;
+    if (header->stringsSize == 0 ||
+        tablesSize + header->stringsSize != size)
+        return false;
+
+    auto cacheDirs = (const CacheDir *)(header + 1);
+    auto cacheFiles = (const CacheFile *)(cacheDirs + header->dirCount);
+    auto cacheApps = (const CacheApp *)(cacheFiles + header->fileCount);
+    auto strings = (const char *)(cacheApps + header->appCount);
+
+    // the string table must end with a null terminator
+    if (strings[header->stringsSize - 1])
+        return false;
+
+    bool valid = true;
+    auto getString = [&](uint32_t offset) {
+        if (offset < header->stringsSize)
+            return strings + offset;
+        valid = false;
+        return "";
+    };
+
+    if (mContext != getString(header->context) ||
+        mDirs.size() != header->dirCount ||
+        mFiles.size() != header->fileCount)
+        return false;
+
+    for (size_t i = 0; i < mDirs.size(); i++)
+    {
+        auto & dir = mDirs[i];
+        auto & cacheDir = cacheDirs[i];
+        if (dir.path != getString(cacheDir.path) ||
+            dir.dev != cacheDir.dev || dir.ino != cacheDir.ino ||
+            dir.mtimeSec != cacheDir.mtimeSec ||
+            dir.mtimeNsec != cacheDir.mtimeNsec)
+            return false;
+    }
+
+    // the IDs are unique, so matching each one checks the whole map
+    for (uint32_t i = 0; i < header->fileCount; i++)
+    {
+        auto & cacheFile = cacheFiles[i];
+        auto found = mFiles.find(QString::fromUtf8(getString(cacheFile.id)));
+        if (found == mFiles.end())
+            return false;
+
+        auto & file = found->second;
+        if (file.path != getString(cacheFile.path) ||
+            file.mtimeSec != cacheFile.mtimeSec ||
+            file.mtimeNsec != cacheFile.mtimeNsec)
+            return false;
+    }
+
+    for (uint32_t i = 0; i < header->appCount && valid; i++)
+    {
+        auto & app = cacheApps[i];
+        AppInfo::Data appData = {
+            QString::fromUtf8(getString(app.displayName)),
+            QString::fromUtf8(getString(app.icon)),
+            QString::fromUtf8(getString(app.executable)),
+            QString::fromUtf8(getString(app.startupWMClass)),
+            QString::fromUtf8(getString(app.genericName)),
+            QString::fromUtf8(getString(app.keywords)),
+            QString::fromUtf8(getString(app.comment)),
+            app.categoryMask};
+
+        auto id = QString::fromUtf8(getString(app.id));
+        apps.try_emplace(id, id, std::move(appData));
+    }
+
+    if (!valid)
+    {
+        qWarning() << "Ignoring corrupt cache" << mPath;
+        apps.clear();
+    }
+
+    return valid;
+}
+
+void AppCache::write(const Resources::AppInfoMap & apps) const
+{
+    QByteArray strings;
+    std::unordered_map<QByteArray, uint32_t> stringOffsets;
+
+    // identical strings (most often empty ones) are stored only once
+    auto addString = [&](const QByteArray & str) {
+        auto result = stringOffsets.try_emplace(str, strings.size());
+        if (result.second)
+            strings.append(str).append('\0');
+        return result.first->second;
+    };
+
+    CacheHeader header = {};
+    memcpy(header.magic, cacheMagic, sizeof cacheMagic);
+    header.version = cacheVersion;
+    header.context = addString(mContext);
+    header.dirCount = mDirs.size();
+    header.fileCount = mFiles.size();
+    header.appCount = apps.size();
+
+    std::vector<CacheDir> cacheDirs;
+    for (auto & dir : mDirs)
+    {
+        cacheDirs.push_back({dir.dev, dir.ino, dir.mtimeSec, dir.mtimeNsec,
+                             addString(dir.path), 0});
+    }
+
+    std::vector<CacheFile> cacheFiles;
+    for (auto & pair : mFiles)
+    {
+        auto & file = pair.second;
+        cacheFiles.push_back({file.mtimeSec, file.mtimeNsec,
+                              addString(pair.first.toUtf8()),
+                              addString(file.path)});
+    }
+
+    std::vector<CacheApp> cacheApps;
+    for (auto & pair : apps)
+    {
+        auto & appData = pair.second.data();
+        cacheApps.push_back({addString(pair.first.toUtf8()),
+                             addString(appData.displayName.toUtf8()),
+                             addString(appData.icon.toUtf8()),
+                             addString(appData.executable.toUtf8()),
+                             addString(appData.startupWMClass.toUtf8()),
+                             addString(appData.genericName.toUtf8()),
+                             addString(appData.keywords.toUtf8()),
+                             addString(appData.comment.toUtf8()),
+                             appData.categoryMask, 0});
+    }
+
+    header.stringsSize = strings.size();
+
+    QByteArray contents;
+    contents.append((const char *)&header, sizeof header);
+    contents.append((const char *)cacheDirs.data(),
+                    sizeof(CacheDir) * cacheDirs.size());
+    contents.append((const char *)cacheFiles.data(),
+                    sizeof(CacheFile) * cacheFiles.size());
+    contents.append((const char *)cacheApps.data(),
+                    sizeof(CacheApp) * cacheApps.size());
+    contents.append(strings);
+
+    // g_file_set_contents() writes to a temporary file and renames it,
+    // so another panel process never sees a partially written cache
+    CharPtr dir(g_path_get_dirname(mPath), g_free);
+    g_mkdir_with_parents(dir.get(), 0700);
+    if (!g_file_set_contents(mPath, contents.constData(), contents.size(),
+                             nullptr))
+        qWarning() << "Failed to write" << mPath;
+}
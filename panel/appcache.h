@@ -0,0 +1,53 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * qmpanel - a minimal Qt-based desktop panel
+ *
+ * Copyright: 2026 John Lindgren
+ * Authors:
+ *   John Lindgren <john@jlindgren.net>
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef APPCACHE_H
+#define APPCACHE_H
+
+#include "appscan.h"
+#include "resources.h"
+
+// Binary index of installed applications, stored under $XDG_CACHE_HOME
+// so that a warm start does not need to parse every .desktop file. The
+// index is invalidated whenever any application directory or .desktop
+// file changes (as recorded in the given AppScan, which must outlive the
+// AppCache), or any directory in $PATH.
+class AppCache
+{
+public:
+    explicit AppCache(const AppScan & scan);
+
+    bool read(Resources::AppInfoMap & apps) const;
+    void write(const Resources::AppInfoMap & apps) const;
+
+private:
+    std::vector<AppScan::Dir> mDirs; // with those in $PATH
+    const AppScan::FileMap & mFiles;
+    QByteArray mPath;
+    QByteArray mContext;
+};
+
+#endif
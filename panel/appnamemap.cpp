@@ -0,0 +1,127 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * qmpanel - a minimal Qt-based desktop panel
+ *
+ * Copyright: 2026 John Lindgren
+ * Authors:
+ *   John Lindgren <john@jlindgren.net>
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "appnamemap.h"
+
+// If another application has the same name, the first added keeps it.
+// Every name is recorded for the application, though, so that it can
+// take the name over when the first is removed.
+void AppNameMap::add(const QString & appID, const AppInfo::Data & data)
+{
+    auto & names = mAppNames[appID];
+    auto addName = [&](const QString & name) {
+        names.append(name);
+        mAppIDs.try_emplace(name, appID);
+    };
+
+    // strip ".desktop" and any reverse-DNS prefix
+    QStringView name(appID);
+    if (name.endsWith(QLatin1String(".desktop")))
+        name.chop(8);
+    name = name.mid(name.lastIndexOf('.') + 1);
+    addName(intern(appID, name));
+
+    // Also map by executable name (if different than app name)
+    // and StartupWMClass key. Maybe it's redundant to check both?
+    // Either one gives (for example): gimp-2.10 -> gimp.desktop.
+    // But "VirtualBox Manager" matches only StartupWMClass.
+    auto & exec = data.executable;
+    auto execName = QStringView(exec).mid(exec.lastIndexOf('/') + 1);
+    if (!execName.isEmpty())
+        addName(intern(exec, execName));
+
+    auto & wmClass = data.startupWMClass;
+    if (!wmClass.isEmpty())
+        addName(intern(wmClass, wmClass));
+}
+
+void AppNameMap::remove(const QString & appID)
+{
+    auto found = mAppNames.find(appID);
+    if (found == mAppNames.end())
+        return;
+
+    // interned names are kept, since the application may come back
+    QStringList names = std::move(found->second);
+    mAppNames.erase(found);
+
+    for (auto & name : names)
+    {
+        auto iter = mAppIDs.find(name);
+        if (iter == mAppIDs.end() || iter->second != appID)
+            continue;
+
+        // another application with the same name (if any) takes it over
+        QString other;
+        for (auto & pair : mAppNames)
+        {
+            if ((other.isEmpty() || pair.first < other) &&
+                pair.second.contains(name))
+                other = pair.first;
+        }
+
+        if (other.isEmpty())
+            mAppIDs.erase(iter);
+        else
+            iter->second = other;
+    }
+}
+
+QString AppNameMap::find(const QString & name) const
+{
+    auto iter = mAppIDs.find(name.toLower());
+    return (iter != mAppIDs.end()) ? iter->second : QString();
+}
+
+// Returns the interned lowercase copy of part of a string. The copy is
+// made in a reused buffer, so nothing is allocated for a name that was
+// seen before. A new name that is the whole string and already lowercase
+// shares that string's storage.
+const QString & AppNameMap::intern(const QString & str, QStringView part)
+{
+    bool ascii = true;
+    mScratch.resize(part.size());
+    auto out = mScratch.data();
+    for (auto c : part)
+    {
+        ascii &= (c.unicode() < 0x80);
+        *out++ = c.toLower();
+    }
+
+    // other scripts may change length when lowercased
+    if (!ascii)
+        mScratch = part.toString().toLower();
+
+    auto iter = mNames.find(mScratch);
+    if (iter != mNames.end())
+        return *iter;
+
+    if (part.size() == str.size() && mScratch == str)
+        return *mNames.insert(str).first;
+
+    // an exact-size copy, leaving the buffer to be reused
+    return *mNames.emplace(mScratch.constData(), mScratch.size()).first;
+}
@@ -0,0 +1,62 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * qmpanel - a minimal Qt-based desktop panel
+ *
+ * Copyright: 2026 John Lindgren
+ * Authors:
+ *   John Lindgren <john@jlindgren.net>
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef APPNAMEMAP_H
+#define APPNAMEMAP_H
+
+#include "resources.h"
+
+#include <unordered_map>
+#include <unordered_set>
+
+// Maps short application names to desktop IDs, for finding the icons of
+// windows and tray items. Example: thunderbird ->
+// org.mozilla.Thunderbird.desktop
+//
+// Names are derived from the desktop ID, executable and StartupWMClass
+// by plain string scanning. They are interned, so that a name derived
+// more than once (from several keys or applications, or again after the
+// applications are rescanned) shares one allocation.
+class AppNameMap
+{
+public:
+    void add(const QString & appID, const AppInfo::Data & data);
+    void remove(const QString & appID);
+
+    // returns an empty string if the name is not known
+    QString find(const QString & name) const;
+
+private:
+    const QString & intern(const QString & str, QStringView part);
+
+    std::unordered_set<QString> mNames;
+    std::unordered_map<QString, QString> mAppIDs;
+    // all names of each application, including those another one has
+    std::unordered_map<QString, QStringList> mAppNames;
+    QString mScratch; // reused to avoid allocating for known names
+};
+
+#endif
@@ -0,0 +1,105 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * qmpanel - a minimal Qt-based desktop panel
+ *
+ * Copyright: 2026 John Lindgren
+ * Authors:
+ *   John Lindgren <john@jlindgren.net>
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "appscan.h"
+#include "utils.h"
+
+#include <glib.h>
+#include <sys/stat.h>
+#include <thread>
+
+AppScan::AppScan()
+{
+    std::vector<QByteArray> paths = {QByteArray(g_get_user_data_dir()) +
+                                     "/applications"};
+    for (auto dir = g_get_system_data_dirs(); *dir; dir++)
+        paths.push_back(QByteArray(*dir) + "/applications");
+
+    // scan each top-level directory in parallel
+    std::vector<Tree> trees(paths.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < paths.size(); i++)
+        threads.emplace_back(scanDir, std::ref(trees[i]), paths[i], QString());
+
+    for (auto & thread : threads)
+        thread.join();
+
+    for (auto & tree : trees)
+    {
+        mDirs.insert(mDirs.end(), tree.dirs.begin(), tree.dirs.end());
+        // insert() keeps files found in higher-priority directories
+        mFiles.insert(tree.files.begin(), tree.files.end());
+    }
+}
+
+void AppScan::scanDir(Tree & tree, const QByteArray & path,
+                      const QString & idPrefix)
+{
+    // Record missing top-level directories too, so that we notice if
+    // they are created. Device and inode numbers are compared as well,
+    // since mtimes may not change when a symlink (e.g. a Nix profile)
+    // is switched. They also protect against symlink loops.
+    struct stat st;
+    if (stat(path, &st) < 0 || !S_ISDIR(st.st_mode))
+    {
+        if (idPrefix.isEmpty())
+            tree.dirs.push_back({path, 0, 0, 0, 0});
+        return;
+    }
+
+    if (!tree.visited.emplace(st.st_dev, st.st_ino).second)
+        return;
+
+    tree.dirs.push_back({path, (int64_t)st.st_dev, (int64_t)st.st_ino,
+                         (int64_t)st.st_mtim.tv_sec,
+                         (int64_t)st.st_mtim.tv_nsec});
+
+    AutoPtr<GDir> dir(g_dir_open(path, 0, nullptr), g_dir_close);
+    if (!dir)
+        return;
+
+    while (auto name = g_dir_read_name(dir.get()))
+    {
+        // Subdirectories are scanned as in GIO, giving desktop IDs
+        // such as kde4-app.desktop for kde4/app.desktop
+        auto subPath = path + '/' + name;
+        if (g_str_has_suffix(name, ".desktop"))
+        {
+            // a dangling symlink still shadows other files
+            File file = {subPath, 0, 0};
+            if (stat(subPath, &st) == 0)
+            {
+                file.mtimeSec = st.st_mtim.tv_sec;
+                file.mtimeNsec = st.st_mtim.tv_nsec;
+            }
+
+            tree.files.insert_or_assign(idPrefix + QString::fromUtf8(name),
+                                        file);
+        }
+        else
+            scanDir(tree, subPath, idPrefix + QString::fromUtf8(name) + '-');
+    }
+}
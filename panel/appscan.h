@@ -0,0 +1,83 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * qmpanel - a minimal Qt-based desktop panel
+ *
+ * Copyright: 2026 John Lindgren
+ * Authors:
+ *   John Lindgren <john@jlindgren.net>
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef APPSCAN_H
+#define APPSCAN_H
+
+#include <QByteArray>
+#include <QString>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+// Lists the .desktop files in the XDG application directories without
+// parsing them. As in GIO, the first file found for each desktop ID
+// (in order of directory priority) shadows any others.
+class AppScan
+{
+public:
+    struct Dir
+    {
+        QByteArray path;
+        int64_t dev, ino, mtimeSec, mtimeNsec;
+    };
+
+    struct File
+    {
+        QByteArray path;
+        int64_t mtimeSec, mtimeNsec;
+
+        bool operator==(const File & other) const
+        {
+            return path == other.path && mtimeSec == other.mtimeSec &&
+                   mtimeNsec == other.mtimeNsec;
+        }
+    };
+
+    using FileMap = std::unordered_map<QString, File>;
+
+    AppScan(); // scans the directories immediately
+
+    const std::vector<Dir> & dirs() const { return mDirs; }
+    const FileMap & files() const { return mFiles; }
+
+private:
+    // results of scanning one top-level directory
+    struct Tree
+    {
+        std::vector<Dir> dirs;
+        std::set<std::pair<int64_t, int64_t>> visited;
+        FileMap files;
+    };
+
+    static void scanDir(Tree & tree, const QByteArray & path,
+                        const QString & idPrefix);
+
+    std::vector<Dir> mDirs;
+    FileMap mFiles;
+};
+
+#endif
@@ -0,0 +1,346 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * qmpanel - a minimal Qt-based desktop panel
+ *
+ * Copyright: 2026 John Lindgren
+ * Authors:
+ *   John Lindgren <john@jlindgren.net>
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "desktopfile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <glib.h>
+#include <string.h>
+#include <thread>
+
+// a localized value, ranked by its locale's position in the user's
+// list of preferred languages (the unlocalized value ranks last)
+struct LocaleString
+{
+    QByteArray value;
+    int rank = INT_MAX;
+};
+
+static bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+static bool equals(const char * start, const char * end, const char * str)
+{
+    size_t len = strlen(str);
+    return (size_t)(end - start) == len && !memcmp(start, str, len);
+}
+
+static int localeRank(const char * start, const char * end)
+{
+    auto langs = g_get_language_names();
+    for (int i = 0; langs[i]; i++)
+    {
+        if (equals(start, end, langs[i]))
+            return i;
+    }
+
+    return -1;
+}
+
+// handles the escape sequences allowed in string values
+static QByteArray unescape(const char * start, const char * end)
+{
+    QByteArray str;
+    str.reserve(end - start);
+
+    for (auto p = start; p < end; p++)
+    {
+        if (*p != '\\' || p + 1 == end)
+        {
+            str.append(*p);
+            continue;
+        }
+
+        switch (*++p)
+        {
+        case 's':
+            str.append(' ');
+            break;
+        case 'n':
+            str.append('\n');
+            break;
+        case 't':
+            str.append('\t');
+            break;
+        case 'r':
+            str.append('\r');
+            break;
+        case '\\':
+            str.append('\\');
+            break;
+        default:
+            str.append('\\').append(*p);
+            break;
+        }
+    }
+
+    return str;
+}
+
+static QList<QByteArray> splitList(const QByteArray & value, char sep)
+{
+    QList<QByteArray> list;
+    for (auto & item : value.split(sep))
+    {
+        if (!item.isEmpty())
+            list.append(item);
+    }
+
+    return list;
+}
+
+// same logic as g_desktop_app_info_get_show_in()
+static bool showInCurrentDesktop(const std::optional<QByteArray> & onlyShowIn,
+                                 const std::optional<QByteArray> & notShowIn)
+{
+    static const QList<QByteArray> desktops =
+        splitList(qgetenv("XDG_CURRENT_DESKTOP"), ':');
+
+    auto onlyList = splitList(onlyShowIn.value_or(QByteArray()), ';');
+    auto notList = splitList(notShowIn.value_or(QByteArray()), ';');
+
+    for (auto & desktop : desktops)
+    {
+        if (onlyList.contains(desktop))
+            return true;
+        if (notList.contains(desktop))
+            return false;
+    }
+
+    return !onlyShowIn;
+}
+
+static uint32_t parseCategories(const QByteArray & categories)
+{
+    uint32_t mask = 0;
+    for (auto & category : categories.split(';'))
+    {
+        for (int i = 0; i < numMenuCategories; i++)
+        {
+            if (!qstricmp(category, menuCategories[i].internalName))
+                mask |= (1u << i);
+        }
+    }
+
+    return mask;
+}
+
+static bool findProgram(const char * program)
+{
+    return (bool)CharPtr(g_find_program_in_path(program), g_free);
+}
+
+bool readDesktopFile(const QByteArray & path, AppInfo::Data & data)
+{
+    AutoPtr<GMappedFile> file(g_mapped_file_new(path, false, nullptr),
+                              g_mapped_file_unref);
+    if (!file)
+        return false;
+
+    auto p = (const char *)g_mapped_file_get_contents(file.get());
+    auto end = p + g_mapped_file_get_length(file.get());
+
+    bool inGroup = false, foundGroup = false;
+    QByteArray type, categories, exec, tryExec, wmClass;
+    std::optional<QByteArray> onlyShowIn, notShowIn;
+    bool noDisplay = false, hidden = false;
+    LocaleString name, fullName, icon, genericName, keywords, comment;
+
+    while (p < end)
+    {
+        auto line = p;
+        auto lineEnd = (const char *)memchr(p, '\n', end - p);
+        if (lineEnd)
+            p = lineEnd + 1;
+        else
+            p = lineEnd = end;
+
+        while (line < lineEnd && isSpace(*line))
+            line++;
+        while (lineEnd > line && isSpace(lineEnd[-1]))
+            lineEnd--;
+
+        if (line == lineEnd || *line == '#')
+            continue;
+
+        if (*line == '[')
+        {
+            // only the first [Desktop Entry] group is read
+            if (inGroup)
+                break;
+
+            inGroup = equals(line, lineEnd, "[Desktop Entry]");
+            foundGroup |= inGroup;
+            continue;
+        }
+
+        auto eq = (const char *)memchr(line, '=', lineEnd - line);
+        if (!inGroup || !eq)
+            continue;
+
+        auto keyEnd = eq;
+        while (keyEnd > line && isSpace(keyEnd[-1]))
+            keyEnd--;
+
+        auto value = eq + 1;
+        while (value < lineEnd && isSpace(*value))
+            value++;
+
+        // split off the locale, e.g. Name[de]
+        auto baseEnd = keyEnd;
+        int rank = INT_MAX - 1;
+        auto locale = (const char *)memchr(line, '[', keyEnd - line);
+        if (locale)
+        {
+            if (keyEnd[-1] != ']' ||
+                (rank = localeRank(locale + 1, keyEnd - 1)) < 0)
+                continue;
+            baseEnd = locale;
+        }
+
+        // as in GKeyFile, the last occurrence of a key wins
+        auto setLocaleString = [&](LocaleString & str) {
+            if (rank <= str.rank)
+            {
+                str.value = unescape(value, lineEnd);
+                str.rank = rank;
+            }
+        };
+
+        if (equals(line, baseEnd, "Name"))
+            setLocaleString(name);
+        else if (equals(line, baseEnd, "X-GNOME-FullName"))
+            setLocaleString(fullName);
+        else if (equals(line, baseEnd, "Icon"))
+            setLocaleString(icon);
+        else if (equals(line, baseEnd, "GenericName"))
+            setLocaleString(genericName);
+        else if (equals(line, baseEnd, "Keywords"))
+            setLocaleString(keywords);
+        else if (equals(line, baseEnd, "Comment"))
+            setLocaleString(comment);
+        else if (locale)
+            continue; // other keys are not localized
+        else if (equals(line, keyEnd, "Type"))
+            type = unescape(value, lineEnd);
+        else if (equals(line, keyEnd, "Categories"))
+            categories = unescape(value, lineEnd);
+        else if (equals(line, keyEnd, "Exec"))
+            exec = unescape(value, lineEnd);
+        else if (equals(line, keyEnd, "TryExec"))
+            tryExec = unescape(value, lineEnd);
+        else if (equals(line, keyEnd, "StartupWMClass"))
+            wmClass = unescape(value, lineEnd);
+        else if (equals(line, keyEnd, "OnlyShowIn"))
+            onlyShowIn = unescape(value, lineEnd);
+        else if (equals(line, keyEnd, "NotShowIn"))
+            notShowIn = unescape(value, lineEnd);
+        else if (equals(line, keyEnd, "NoDisplay"))
+            noDisplay = equals(value, lineEnd, "true") ||
+                        equals(value, lineEnd, "1");
+        else if (equals(line, keyEnd, "Hidden"))
+            hidden = equals(value, lineEnd, "true") ||
+                     equals(value, lineEnd, "1");
+    }
+
+    if (!foundGroup || type != "Application" || hidden)
+        return false;
+
+    // GIO skips applications whose programs are not installed
+    if (!tryExec.isEmpty() && !findProgram(tryExec))
+        return false;
+
+    if (!exec.isEmpty())
+    {
+        char ** argv;
+        if (!g_shell_parse_argv(exec, nullptr, &argv, nullptr))
+            return false;
+
+        bool found = findProgram(argv[0]);
+        g_strfreev(argv);
+        if (!found)
+            return false;
+    }
+
+    // work around a common mistake (as GIO does)
+    if (!g_path_is_absolute(icon.value) &&
+        (icon.value.endsWith(".png") || icon.value.endsWith(".svg") ||
+         icon.value.endsWith(".xpm")))
+        icon.value.chop(4);
+
+    // g_app_info_get_executable() returns the first word of Exec
+    int space = exec.indexOf(' ');
+    if (space >= 0)
+        exec.truncate(space);
+
+    auto & displayName = (fullName.rank < INT_MAX) ? fullName : name;
+
+    data.displayName = (displayName.rank < INT_MAX)
+                           ? QString::fromUtf8(displayName.value)
+                           : QString("Unnamed");
+    data.icon = QString::fromUtf8(icon.value);
+    data.executable = QString::fromUtf8(exec);
+    data.startupWMClass = QString::fromUtf8(wmClass);
+    data.genericName = QString::fromUtf8(genericName.value);
+    data.keywords = QString::fromUtf8(keywords.value);
+    data.comment = QString::fromUtf8(comment.value);
+    bool shouldShow =
+        !noDisplay && showInCurrentDesktop(onlyShowIn, notShowIn);
+    data.categoryMask = shouldShow ? parseCategories(categories) : 0;
+
+    return true;
+}
+
+std::vector<std::optional<AppInfo::Data>>
+readDesktopFiles(const std::vector<QByteArray> & paths)
+{
+    std::vector<std::optional<AppInfo::Data>> results(paths.size());
+    std::atomic<size_t> next(0);
+
+    auto readFiles = [&]() {
+        for (size_t i; (i = next++) < paths.size();)
+        {
+            AppInfo::Data data;
+            if (readDesktopFile(paths[i], data))
+                results[i] = std::move(data);
+        }
+    };
+
+    // the calling thread reads files too
+    size_t numThreads =
+        std::min<size_t>(std::thread::hardware_concurrency(), paths.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < numThreads; i++)
+        threads.emplace_back(readFiles);
+
+    readFiles();
+
+    for (auto & thread : threads)
+        thread.join();
+
+    return results;
+}
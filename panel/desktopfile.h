@@ -0,0 +1,44 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * qmpanel - a minimal Qt-based desktop panel
+ *
+ * Copyright: 2026 John Lindgren
+ * Authors:
+ *   John Lindgren <john@jlindgren.net>
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef DESKTOPFILE_H
+#define DESKTOPFILE_H
+
+#include "resources.h"
+
+#include <optional>
+#include <vector>
+
+// Reads only the keys used by the panel from a .desktop file, which is
+// much faster than creating a GDesktopAppInfo. Returns false for hidden
+// or invalid entries, following the same rules as GIO.
+bool readDesktopFile(const QByteArray & path, AppInfo::Data & data);
+
+// Reads many .desktop files in parallel (results are in the same order)
+std::vector<std::optional<AppInfo::Data>>
+readDesktopFiles(const std::vector<QByteArray> & paths);
+
+#endif
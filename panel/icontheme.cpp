@@ -0,0 +1,318 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * qmpanel - a minimal Qt-based desktop panel
+ *
+ * Copyright: 2026 John Lindgren
+ * Authors:
+ *   John Lindgren <john@jlindgren.net>
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "icontheme.h"
+
+#include <algorithm>
+#include <glib.h>
+#include <memory>
+#include <string.h>
+#include <sys/stat.h>
+
+// The cache format is documented in gtk/gtkiconcache.c. All numbers
+// are big-endian, and all offsets are from the start of the file.
+enum
+{
+    HasSuffixXPM = (1 << 0),
+    HasSuffixSVG = (1 << 1),
+    HasSuffixPNG = (1 << 2)
+};
+
+static const uint32_t invalidOffset = 0xffffffff;
+
+// same hash function as GTK
+static uint32_t iconNameHash(const char * name)
+{
+    auto p = (const signed char *)name;
+    uint32_t h = *p;
+    if (h)
+    {
+        for (p++; *p; p++)
+            h = (h << 5) - h + *p;
+    }
+
+    return h;
+}
+
+IconTheme::Cache::Cache(GMappedFile * file)
+    : mFile(file, g_mapped_file_unref),
+      mData(file ? g_mapped_file_get_contents(file) : nullptr),
+      mSize(file ? g_mapped_file_get_length(file) : 0)
+{
+}
+
+uint16_t IconTheme::Cache::get16(uint64_t offset) const
+{
+    if (offset + 2 > mSize)
+        return 0xffff;
+
+    auto p = (const uint8_t *)mData + offset;
+    return (p[0] << 8) | p[1];
+}
+
+uint32_t IconTheme::Cache::get32(uint64_t offset) const
+{
+    if (offset + 4 > mSize)
+        return invalidOffset;
+
+    auto p = (const uint8_t *)mData + offset;
+    return ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+const char * IconTheme::Cache::getString(uint64_t offset) const
+{
+    if (offset >= mSize)
+        return nullptr;
+
+    // must be null-terminated within the file
+    auto str = mData + offset;
+    return memchr(str, 0, mSize - offset) ? str : nullptr;
+}
+
+template<typename F>
+void IconTheme::Cache::find(const char * name, F func) const
+{
+    uint32_t hashOffset = get32(4);
+    uint32_t dirListOffset = get32(8);
+    uint32_t numBuckets = get32(hashOffset);
+    uint32_t numDirs = get32(dirListOffset);
+    if (numBuckets == 0 || numBuckets == invalidOffset)
+        return;
+
+    uint64_t bucket = iconNameHash(name) % numBuckets;
+    uint32_t iconOffset = get32(hashOffset + 4 + 4 * bucket);
+
+    // the count guards against a loop in a corrupt file
+    for (size_t i = 0; iconOffset != invalidOffset && i < mSize; i++)
+    {
+        auto iconName = getString(get32(iconOffset + 4));
+        if (iconName && !strcmp(iconName, name))
+        {
+            uint64_t imageList = get32(iconOffset + 8);
+            uint32_t numImages = get32(imageList);
+
+            for (uint64_t j = 0; j < numImages; j++)
+            {
+                uint64_t image = imageList + 4 + 8 * j;
+                if (image + 8 > mSize)
+                    break;
+
+                uint16_t dirIndex = get16(image);
+                uint16_t flags = get16(image + 2);
+                if (dirIndex >= numDirs)
+                    continue;
+
+                auto dirName =
+                    getString(get32(dirListOffset + 4 + 4 * dirIndex));
+                if (dirName)
+                    func(dirName, flags);
+            }
+
+            return;
+        }
+
+        iconOffset = get32(iconOffset);
+    }
+}
+
+static std::unique_ptr<IconTheme> currentTheme;
+
+const IconTheme & IconTheme::current()
+{
+    auto name = QIcon::themeName();
+    if (!currentTheme || currentTheme->mName != name)
+        currentTheme.reset(new IconTheme(name));
+
+    return *currentTheme;
+}
+
+void IconTheme::invalidate() { currentTheme.reset(); }
+
+IconTheme::IconTheme(const QString & name) : mName(name)
+{
+    addTheme(name.toUtf8());
+    addTheme(QIcon::fallbackThemeName().toUtf8());
+    // hicolor is the last fallback for all themes
+    addTheme("hicolor");
+}
+
+void IconTheme::addTheme(const QByteArray & name)
+{
+    if (name.isEmpty())
+        return;
+
+    for (auto & theme : mThemes)
+    {
+        if (theme.name == name)
+            return;
+    }
+
+    Theme theme;
+    theme.name = name;
+
+    AutoPtr<GKeyFile> index(g_key_file_new(), g_key_file_unref);
+    bool foundIndex = false;
+    bool complete = true;
+
+    for (auto & searchPath : QIcon::themeSearchPaths())
+    {
+        // skip Qt resource paths (":/icons")
+        if (!searchPath.startsWith('/'))
+            continue;
+
+        auto baseDir = searchPath.toUtf8() + '/' + name;
+        struct stat dirStat, cacheStat;
+        if (stat(baseDir, &dirStat) < 0 || !S_ISDIR(dirStat.st_mode))
+            continue;
+
+        mBaseDirs.append(QString::fromUtf8(baseDir));
+
+        if (!foundIndex)
+            foundIndex = g_key_file_load_from_file(
+                index.get(), baseDir + "/index.theme", G_KEY_FILE_NONE,
+                nullptr);
+
+        // as in GTK, ignore a cache that is older than its directory
+        auto cachePath = baseDir + "/icon-theme.cache";
+        GMappedFile * file = nullptr;
+        if (stat(cachePath, &cacheStat) == 0 &&
+            cacheStat.st_mtime >= dirStat.st_mtime)
+            file = g_mapped_file_new(cachePath, false, nullptr);
+
+        Cache cache(file);
+        if (cache.isValid())
+            theme.caches.emplace_back(baseDir, std::move(cache));
+        else
+            complete = false;
+    }
+
+    // like Qt, ignore any theme without an index.theme file
+    if (!foundIndex)
+        return;
+
+    mComplete = mComplete && complete;
+
+    auto getString = [&](const char * group, const char * key) {
+        CharPtr str(g_key_file_get_string(index.get(), group, key, nullptr),
+                    g_free);
+        return QByteArray(str.get());
+    };
+
+    auto dirs = getString("Icon Theme", "Directories").split(',') +
+                getString("Icon Theme", "ScaledDirectories").split(',');
+
+    for (auto & dir : dirs)
+    {
+        auto group = dir.constData();
+        if (dir.isEmpty() || !g_key_file_has_group(index.get(), group))
+            continue;
+
+        int size = g_key_file_get_integer(index.get(), group, "Size", nullptr);
+        int scale =
+            g_key_file_get_integer(index.get(), group, "Scale", nullptr);
+        bool scalable = (getString(group, "Type") == "Scalable");
+        theme.dirs.emplace(dir, DirInfo{size, std::max(scale, 1), scalable});
+    }
+
+    auto parents = getString("Icon Theme", "Inherits").split(',');
+    mThemes.push_back(std::move(theme));
+
+    for (auto & parent : parents)
+        addTheme(parent.trimmed());
+}
+
+QIcon IconFiles::load() const
+{
+    // add the scalable image first so that QIcon uses the SVG engine
+    QIcon icon;
+    if (!scalablePath.isEmpty())
+        icon.addFile(scalablePath);
+    for (auto & [path, size] : sizedPaths)
+        icon.addFile(path, size ? QSize(size, size) : QSize());
+
+    return icon;
+}
+
+IconFiles IconTheme::lookup(const QString & name, bool dashFallback) const
+{
+    auto nameUtf8 = name.toUtf8();
+
+    while (true)
+    {
+        auto files = lookupExact(nameUtf8);
+        int dash = nameUtf8.lastIndexOf('-');
+        if (!files.isEmpty() || !dashFallback || dash <= 0)
+            return files;
+
+        nameUtf8.truncate(dash);
+    }
+}
+
+// searches the whole chain of themes before any fallback
+IconFiles IconTheme::lookupExact(const QByteArray & nameUtf8) const
+{
+    for (auto & theme : mThemes)
+    {
+        IconFiles files;
+        auto & scalablePath = files.scalablePath;
+        auto & sizedPaths = files.sizedPaths;
+
+        for (auto & [baseDir, cache] : theme.caches)
+        {
+            cache.find(nameUtf8, [&](const char * dirName, uint16_t flags) {
+                auto dir = theme.dirs.find(dirName);
+                if (dir == theme.dirs.end())
+                    return;
+
+                auto & info = dir->second;
+                bool svg = (flags & HasSuffixSVG) &&
+                           (info.scalable || !(flags & HasSuffixPNG));
+                auto ext = svg ? ".svg"
+                           : (flags & HasSuffixPNG) ? ".png"
+                           : (flags & HasSuffixXPM) ? ".xpm"
+                                                    : nullptr;
+                if (!ext)
+                    return;
+
+                auto path = QString::fromUtf8(baseDir + '/' + dirName + '/' +
+                                              nameUtf8 + ext);
+
+                if (info.scalable && svg)
+                {
+                    if (scalablePath.isEmpty())
+                        scalablePath = path;
+                }
+                else
+                    sizedPaths.emplace_back(path, info.size * info.scale);
+            });
+        }
+
+        if (!files.isEmpty())
+            return files;
+    }
+
+    return IconFiles();
+}
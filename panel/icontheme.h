@@ -0,0 +1,123 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * qmpanel - a minimal Qt-based desktop panel
+ *
+ * Copyright: 2026 John Lindgren
+ * Authors:
+ *   John Lindgren <john@jlindgren.net>
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef ICONTHEME_H
+#define ICONTHEME_H
+
+#include "utils.h"
+
+#include <QByteArray>
+#include <QIcon>
+#include <QStringList>
+#include <unordered_map>
+#include <vector>
+
+typedef struct _GMappedFile GMappedFile;
+
+// image files found for an icon name
+struct IconFiles
+{
+    QString scalablePath; // SVG
+    std::vector<std::pair<QString, int>> sizedPaths; // with size (or 0)
+
+    bool isEmpty() const
+    {
+        return scalablePath.isEmpty() && sizedPaths.empty();
+    }
+
+    QIcon load() const;
+};
+
+// Resolves icon names using the icon-theme.cache files generated by
+// gtk-update-icon-cache, which are mapped into memory. Each lookup is
+// a hash table probe per theme, with no file system access. Themes
+// without an up-to-date cache are left to QIcon::fromTheme().
+class IconTheme
+{
+public:
+    // reloaded if QIcon::themeName() has changed
+    static const IconTheme & current();
+    // forces a reload (e.g. after a theme directory changed)
+    static void invalidate();
+
+    // Returns no files if not found. As in QIcon::fromTheme(), a name
+    // not found is shortened at each dash in turn if dashFallback is set
+    // (e.g. "folder-music-open" -> "folder-music" -> "folder").
+    IconFiles lookup(const QString & name, bool dashFallback = true) const;
+
+    // true if every theme has a cache (so lookup() misses are final)
+    bool isComplete() const { return mComplete; }
+
+    // existing directories of all themes in the inheritance chain
+    const QStringList & baseDirs() const { return mBaseDirs; }
+
+private:
+    struct DirInfo
+    {
+        int size, scale;
+        bool scalable;
+    };
+
+    class Cache
+    {
+    public:
+        explicit Cache(GMappedFile * file);
+
+        bool isValid() const { return get16(0) == 1 && get16(2) == 0; }
+
+        // calls func(dirName, flags) for each image found
+        template<typename F>
+        void find(const char * name, F func) const;
+
+    private:
+        uint16_t get16(uint64_t offset) const;
+        uint32_t get32(uint64_t offset) const;
+        const char * getString(uint64_t offset) const;
+
+        AutoPtr<GMappedFile> mFile;
+        const char * mData;
+        size_t mSize;
+    };
+
+    struct Theme
+    {
+        QByteArray name;
+        std::vector<std::pair<QByteArray, Cache>> caches; // by base dir
+        std::unordered_map<QByteArray, DirInfo> dirs;
+    };
+
+    explicit IconTheme(const QString & name);
+
+    void addTheme(const QByteArray & name);
+    IconFiles lookupExact(const QByteArray & name) const;
+
+    QString mName;
+    std::vector<Theme> mThemes; // in order of inheritance
+    QStringList mBaseDirs;
+    bool mComplete = true;
+};
+
+#endif
@@ -0,0 +1,322 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * qmpanel - a minimal Qt-based desktop panel
+ *
+ * Copyright: 2026 John Lindgren
+ * Authors:
+ *   John Lindgren <john@jlindgren.net>
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "launcher.h"
+#include "utils.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QSocketNotifier>
+#include <deque>
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#undef signals
+#include <gio/gdesktopappinfo.h>
+#include <gio/gio.h>
+
+static const size_t maxMessage = 4096;
+
+// a request is the type followed by the desktop file ID or command line
+enum RequestType : char
+{
+    LaunchApp = 'a',
+    LaunchCmd = 'c'
+};
+
+// followed by an error message if not started
+struct Reply
+{
+    int32_t started;
+    int32_t pid;
+};
+
+struct PendingReply
+{
+    QByteArray request;
+    QString name; // for error messages
+    Launcher::Callback callback;
+};
+
+static pid_t helperPid = -1;
+static int helperSocket = -1;
+static QSocketNotifier * replyNotifier; // owned by qApp
+// the helper replies to requests in order
+static std::deque<PendingReply> pendingReplies;
+
+static void setPid(GDesktopAppInfo *, GPid pid, void * data)
+{
+    *static_cast<GPid *>(data) = pid;
+}
+
+static bool spawnApp(const char * appID, GPid & pid, QByteArray & error)
+{
+    AutoPtrV<GDesktopAppInfo> info(g_desktop_app_info_new(appID),
+                                   g_object_unref);
+    if (!info)
+    {
+        error = "Failed to load desktop file";
+        return false;
+    }
+
+    // Unset QT_WAYLAND_SHELL_INTEGRATION or else all launched
+    // Qt applications will use layer-shell, wanted or not
+    auto context = g_app_launch_context_new();
+    g_app_launch_context_unsetenv(context, "QT_WAYLAND_SHELL_INTEGRATION");
+
+    GError * gerror = nullptr;
+    bool started = g_desktop_app_info_launch_uris_as_manager(
+        info.get(), nullptr, context, G_SPAWN_SEARCH_PATH, restore_signals,
+        nullptr, setPid, &pid, &gerror);
+
+    if (gerror)
+    {
+        error = gerror->message;
+        g_error_free(gerror);
+    }
+
+    g_object_unref(context);
+    return started;
+}
+
+static bool spawnCmd(const char * cmd, GPid & pid, QByteArray & error)
+{
+    char ** env =
+        g_environ_unsetenv(g_get_environ(), "QT_WAYLAND_SHELL_INTEGRATION");
+    char ** args = g_strsplit(cmd, " ", -1);
+
+    GError * gerror = nullptr;
+    bool started = g_spawn_async(nullptr, args, env, G_SPAWN_SEARCH_PATH,
+                                 restore_signals, nullptr, &pid, &gerror);
+
+    if (gerror)
+    {
+        error = gerror->message;
+        g_error_free(gerror);
+    }
+
+    g_strfreev(args);
+    g_strfreev(env);
+    return started;
+}
+
+// Starts the request in this process, or in the helper process (in
+// which case the error is sent back in the reply).
+static bool spawn(const char * request, GPid & pid, QByteArray & error)
+{
+    pid = 0;
+    switch (request[0])
+    {
+    case LaunchApp:
+        return spawnApp(request + 1, pid, error);
+    case LaunchCmd:
+        return spawnCmd(request + 1, pid, error);
+    default:
+        error = "Invalid request";
+        return false;
+    }
+}
+
+// in the panel process, if the helper is not running
+static void spawnDirectly(const QByteArray & request, const QString & name,
+                          const Launcher::Callback & callback)
+{
+    GPid pid;
+    QByteArray error;
+    bool started = spawn(request.constData(), pid, error);
+    if (!started)
+        qWarning() << "Failed to launch" << name << ":" << error;
+
+    if (callback)
+        callback(started, pid);
+}
+
+// Runs in the helper process until the panel exits. There is nothing to
+// reap, since GLib spawns each application from an intermediate child
+// (which it reaps itself) unless told not to.
+[[noreturn]] static void runHelper(int sock)
+{
+    char request[maxMessage + 1];
+
+    // blocked in the panel only so that its signal thread gets them
+    restore_signals(nullptr);
+
+    while (true)
+    {
+        ssize_t len = recv(sock, request, maxMessage, 0);
+        if (len < 0 && errno == EINTR)
+            continue;
+        if (len <= 0)
+            break; // the panel has exited
+
+        request[len] = 0;
+
+        GPid childPid;
+        QByteArray error;
+        Reply reply;
+        reply.started = spawn(request, childPid, error);
+        reply.pid = childPid;
+
+        QByteArray message((const char *)&reply, sizeof reply);
+        message += error.left(maxMessage - sizeof reply);
+        send(sock, message.constData(), message.size(), MSG_NOSIGNAL);
+    }
+
+    _exit(0);
+}
+
+static void stopHelper()
+{
+    qWarning() << "Launcher helper exited; launching directly";
+
+    if (replyNotifier)
+    {
+        replyNotifier->setEnabled(false);
+        replyNotifier->deleteLater();
+        replyNotifier = nullptr;
+    }
+
+    close(helperSocket);
+    helperSocket = -1;
+    waitpid(helperPid, nullptr, WNOHANG);
+
+    // Whether these were started is not known, but the helper replies
+    // right after starting each one, so most likely they were not
+    auto pending = std::move(pendingReplies);
+    pendingReplies.clear();
+    for (auto & reply : pending)
+        spawnDirectly(reply.request, reply.name, reply.callback);
+}
+
+static void readReplies()
+{
+    char message[maxMessage];
+
+    while (helperSocket >= 0)
+    {
+        ssize_t len = recv(helperSocket, message, sizeof message,
+                           MSG_DONTWAIT);
+        if (len < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return;
+
+        if (len < (ssize_t)sizeof(Reply) || pendingReplies.empty())
+        {
+            stopHelper();
+            return;
+        }
+
+        Reply reply;
+        memcpy(&reply, message, sizeof reply);
+        auto pending = std::move(pendingReplies.front());
+        pendingReplies.pop_front();
+
+        if (!reply.started)
+        {
+            QByteArray error(message + sizeof reply, len - sizeof reply);
+            qWarning() << "Failed to launch" << pending.name << ":" << error;
+        }
+
+        if (pending.callback)
+            pending.callback(reply.started, reply.pid);
+    }
+}
+
+// returns false if the helper is not running
+static bool sendRequest(const QByteArray & request, const QString & name,
+                        Launcher::Callback & callback)
+{
+    if (helperSocket < 0 || (size_t)request.size() > maxMessage)
+        return false;
+
+    if (send(helperSocket, request.constData(), request.size(),
+             MSG_NOSIGNAL) < 0)
+    {
+        stopHelper();
+        return false;
+    }
+
+    if (!replyNotifier)
+    {
+        replyNotifier = new QSocketNotifier(helperSocket,
+                                            QSocketNotifier::Read, qApp);
+        QObject::connect(replyNotifier, &QSocketNotifier::activated,
+                         readReplies);
+    }
+
+    pendingReplies.push_back({request, name, std::move(callback)});
+    return true;
+}
+
+static void launch(RequestType type, const QString & arg,
+                   Launcher::Callback callback)
+{
+    QByteArray request(1, type);
+    request += arg.toUtf8();
+
+    if (!sendRequest(request, arg, callback))
+        spawnDirectly(request, arg, callback);
+}
+
+void Launcher::startHelper()
+{
+    int socks[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, socks) < 0)
+    {
+        qWarning() << "Failed to create launcher socket";
+        return;
+    }
+
+    helperPid = fork();
+    if (helperPid < 0)
+    {
+        qWarning() << "Failed to start launcher helper";
+        close(socks[0]);
+        close(socks[1]);
+        return;
+    }
+
+    if (helperPid == 0)
+    {
+        close(socks[0]);
+        runHelper(socks[1]);
+    }
+
+    close(socks[1]);
+    helperSocket = socks[0];
+}
+
+void Launcher::launchApp(const QString & appID, Callback callback)
+{
+    launch(LaunchApp, appID, std::move(callback));
+}
+
+void Launcher::launchCmd(const QString & cmd)
+{
+    launch(LaunchCmd, cmd, nullptr);
+}
@@ -0,0 +1,56 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * qmpanel - a minimal Qt-based desktop panel
+ *
+ * Copyright: 2026 John Lindgren
+ * Authors:
+ *   John Lindgren <john@jlindgren.net>
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef LAUNCHER_H
+#define LAUNCHER_H
+
+#include <QString>
+#include <functional>
+
+void restore_signals(void *); // from main.cpp
+
+// Starts applications from a small helper process, forked early in
+// main() while the panel is still small. Otherwise, the whole panel
+// (with Qt, GIO and all caches mapped) would be forked for each launch.
+// If the helper is not running, applications are started directly.
+class Launcher
+{
+public:
+    // pid is 0 if not known (e.g. for D-Bus activated applications)
+    using Callback = std::function<void(bool started, int pid)>;
+
+    // call before any threads are created
+    static void startHelper();
+
+    // Starts the application with the given desktop file ID. Failures
+    // are logged. The callback is usually called later, once the helper
+    // has replied.
+    static void launchApp(const QString & appID, Callback callback);
+    // runs a command line (split at spaces)
+    static void launchCmd(const QString & cmd);
+};
+
+#endif
@@ -0,0 +1,154 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * qmpanel - a minimal Qt-based desktop panel
+ *
+ * Copyright: 2026 John Lindgren
+ * Authors:
+ *   John Lindgren <john@jlindgren.net>
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "launchhistory.h"
+#include "utils.h"
+
+#include <QDebug>
+#include <cmath>
+#include <stdio.h>
+
+#undef signals
+#include <glib.h>
+
+// weight of a launch halves after this many seconds
+static const double halfLife = 14 * 24 * 3600;
+// applications whose score decays below this are dropped when compacting
+static const double minScore = 0.05;
+// lines allowed in the log beyond one for each application
+static const int maxExtraLines = 256;
+
+LaunchHistory & LaunchHistory::instance()
+{
+    static LaunchHistory history;
+    return history;
+}
+
+// Each line is "<time> <weight> <app ID>", where the time is in seconds
+// since the Unix epoch and the weight is 1 for a single launch. Scores
+// are kept relative to the time of loading, since scaling all of them
+// by the same factor (as time passes) does not change their order.
+LaunchHistory::LaunchHistory()
+    : mPath(QByteArray(g_get_user_state_dir()) + "/qmpanel/launches.log"),
+      mEpoch(g_get_real_time() / G_USEC_PER_SEC)
+{
+    char * contents = nullptr;
+    if (!g_file_get_contents(mPath, &contents, nullptr, nullptr))
+        return;
+
+    CharPtr owner(contents, g_free);
+    for (auto & line : QByteArray(contents).split('\n'))
+    {
+        const char * str = line.constData();
+        char * end = nullptr;
+
+        long long time = g_ascii_strtoll(str, &end, 10);
+        if (end == str || *end != ' ')
+            continue;
+
+        // written with a '.' (by QByteArray::number()) in any locale
+        str = end + 1;
+        double weight = g_ascii_strtod(str, &end);
+        if (end == str || *end != ' ' || !(weight > 0) || !end[1])
+            continue;
+
+        auto appID = QString::fromUtf8(end + 1);
+        mScores[appID] += weight * weightAt(time);
+        mLines++;
+    }
+
+    if (needsCompact())
+        compact();
+}
+
+void LaunchHistory::record(const QString & appID)
+{
+    int64_t time = g_get_real_time() / G_USEC_PER_SEC;
+    mScores[appID] += weightAt(time);
+
+    CharPtr dir(g_path_get_dirname(mPath), g_free);
+    g_mkdir_with_parents(dir.get(), 0700);
+
+    // the log is only appended to, so nothing is lost if this fails
+    auto file = fopen(mPath, "a");
+    if (!file)
+    {
+        qWarning() << "Failed to write" << mPath;
+        return;
+    }
+
+    fprintf(file, "%lld 1 %s\n", (long long)time, appID.toUtf8().constData());
+    fclose(file);
+    mLines++;
+
+    if (needsCompact())
+        compact();
+}
+
+double LaunchHistory::weightAt(int64_t time) const
+{
+    return std::exp2((time - mEpoch) / halfLife);
+}
+
+bool LaunchHistory::needsCompact() const
+{
+    return mLines > (int)mScores.size() + maxExtraLines;
+}
+
+// writes the current scores (as weights at the epoch) over the log
+void LaunchHistory::compact()
+{
+    // how much more a launch now weighs than one at the epoch
+    double decay = weightAt(g_get_real_time() / G_USEC_PER_SEC);
+
+    QByteArray contents;
+    for (auto it = mScores.begin(); it != mScores.end();)
+    {
+        if (it->second / decay < minScore)
+        {
+            it = mScores.erase(it);
+            continue;
+        }
+
+        contents += QByteArray::number((qlonglong)mEpoch) + ' ' +
+                    QByteArray::number(it->second, 'g', 6) + ' ' +
+                    it->first.toUtf8() + '\n';
+        ++it;
+    }
+
+    // g_file_set_contents() writes to a temporary file and renames it,
+    // so that launches are not lost if writing is interrupted
+    CharPtr dir(g_path_get_dirname(mPath), g_free);
+    g_mkdir_with_parents(dir.get(), 0700);
+    if (!g_file_set_contents(mPath, contents.constData(), contents.size(),
+                             nullptr))
+    {
+        qWarning() << "Failed to write" << mPath;
+        return;
+    }
+
+    mLines = mScores.size();
+}
@@ -0,0 +1,67 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * qmpanel - a minimal Qt-based desktop panel
+ *
+ * Copyright: 2026 John Lindgren
+ * Authors:
+ *   John Lindgren <john@jlindgren.net>
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef LAUNCHHISTORY_H
+#define LAUNCHHISTORY_H
+
+#include <QByteArray>
+#include <QString>
+#include <unordered_map>
+
+// Record of application launches, used to rank frequently and recently
+// launched applications first. Each launch is appended as a line to a
+// log under $XDG_STATE_HOME, which is rewritten with one line for each
+// application (with its combined weight) once it grows too long.
+class LaunchHistory
+{
+public:
+    // the log is read when first called
+    static LaunchHistory & instance();
+
+    // 0 if never launched, otherwise higher is better (only comparable
+    // to other scores during the same run)
+    double score(const QString & appID) const
+    {
+        auto it = mScores.find(appID);
+        return (it != mScores.end()) ? it->second : 0;
+    }
+
+    void record(const QString & appID);
+
+private:
+    LaunchHistory();
+
+    double weightAt(int64_t time) const;
+    bool needsCompact() const;
+    void compact();
+
+    QByteArray mPath;
+    int64_t mEpoch; // time at which scores are unscaled
+    std::unordered_map<QString, double> mScores;
+    int mLines = 0;
+};
+
+#endif
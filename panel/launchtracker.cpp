@@ -0,0 +1,166 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * qmpanel - a minimal Qt-based desktop panel
+ *
+ * Copyright: 2026 John Lindgren
+ * Authors:
+ *   John Lindgren <john@jlindgren.net>
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "launchtracker.h"
+#include "utils.h"
+
+#include <QDebug>
+#include <algorithm>
+#include <stdio.h>
+
+#undef signals
+#include <glib.h>
+
+// launches without a window after this long are forgotten
+static const int64_t windowTimeoutMs = 60 * 1000;
+
+LaunchTracker & LaunchTracker::instance()
+{
+    static LaunchTracker tracker;
+    return tracker;
+}
+
+LaunchTracker::LaunchTracker()
+    : mPath(QByteArray(g_get_user_state_dir()) + "/qmpanel/launch-times")
+{
+    mClock.start();
+
+    char * contents = nullptr;
+    if (!g_file_get_contents(mPath, &contents, nullptr, nullptr))
+        return;
+
+    CharPtr owner(contents, g_free);
+    for (auto & line : QByteArray(contents).split('\n'))
+    {
+        int launches;
+        long long totalMs, maxMs;
+        int idStart = 0;
+        if (sscanf(line.constData(), "%d %lld %lld %n", &launches, &totalMs,
+                   &maxMs, &idStart) < 3 ||
+            idStart <= 0 || idStart >= line.size() || launches <= 0)
+            continue;
+
+        auto appID = QString::fromUtf8(line.mid(idStart));
+        mStats[appID] = {launches, totalMs, maxMs};
+    }
+}
+
+int LaunchTracker::launching(const QString & appID, const QString & wmClass)
+{
+    expire();
+
+    // The app_id (or WM class) is usually the desktop file ID, or for
+    // reverse-DNS IDs (org.example.App), sometimes only the last part
+    QString name = appID;
+    if (name.endsWith(".desktop"))
+        name.chop(8);
+
+    QStringList names = {name.toLower()};
+    auto lastPart = name.section('.', -1).toLower();
+    if (lastPart != names[0])
+        names.append(lastPart);
+    if (!wmClass.isEmpty())
+        names.append(wmClass.toLower());
+
+    mLaunches.push_back({++mLastID, appID, names, 0, mClock.elapsed()});
+    return mLastID;
+}
+
+void LaunchTracker::started(int launch, bool ok, int pid)
+{
+    auto hasID = [launch](const Launch & l) { return l.id == launch; };
+    auto it = std::find_if(mLaunches.begin(), mLaunches.end(), hasID);
+    if (it == mLaunches.end())
+        return;
+
+    if (ok)
+        it->pid = pid;
+    else
+        mLaunches.erase(it);
+}
+
+void LaunchTracker::windowAdded(int pid, const QStringList & names)
+{
+    expire();
+
+    QStringList lower;
+    for (auto & name : names)
+    {
+        if (!name.isEmpty())
+            lower.append(name.toLower());
+    }
+
+    for (auto it = mLaunches.begin(); it != mLaunches.end(); ++it)
+    {
+        bool pidMatch = (pid > 0 && it->pid == pid);
+        auto hasName = [it](const QString & name) {
+            return it->names.contains(name);
+        };
+
+        if (!pidMatch && std::none_of(lower.begin(), lower.end(), hasName))
+            continue;
+
+        int64_t ms = mClock.elapsed() - it->startMs;
+        auto & stats = mStats[it->appID];
+        stats.launches++;
+        stats.totalMs += ms;
+        stats.maxMs = std::max(stats.maxMs, ms);
+
+        mLaunches.erase(it);
+        write();
+        return;
+    }
+}
+
+void LaunchTracker::expire()
+{
+    int64_t now = mClock.elapsed();
+    auto expired = [now](const Launch & l) {
+        return now - l.startMs > windowTimeoutMs;
+    };
+
+    mLaunches.erase(
+        std::remove_if(mLaunches.begin(), mLaunches.end(), expired),
+        mLaunches.end());
+}
+
+void LaunchTracker::write() const
+{
+    QByteArray contents;
+    for (auto & [appID, stats] : mStats)
+    {
+        contents += QByteArray::number(stats.launches) + ' ' +
+                    QByteArray::number((qlonglong)stats.totalMs) + ' ' +
+                    QByteArray::number((qlonglong)stats.maxMs) + ' ' +
+                    appID.toUtf8() + '\n';
+    }
+
+    CharPtr dir(g_path_get_dirname(mPath), g_free);
+    g_mkdir_with_parents(dir.get(), 0700);
+    if (!g_file_set_contents(mPath, contents.constData(), contents.size(),
+                             nullptr))
+        qWarning() << "Failed to write" << mPath;
+}
@@ -0,0 +1,89 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * qmpanel - a minimal Qt-based desktop panel
+ *
+ * Copyright: 2026 John Lindgren
+ * Authors:
+ *   John Lindgren <john@jlindgren.net>
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef LAUNCHTRACKER_H
+#define LAUNCHTRACKER_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <unordered_map>
+#include <vector>
+
+// Measures the time from launching each application until its first
+// window appears in the task bar. A window is matched to a launch by its
+// process ID, or else by its WM class (X11) or app_id (Wayland). Totals
+// for each application are kept in $XDG_STATE_HOME/qmpanel/launch-times
+// (one line of "<launches> <total ms> <max ms> <app ID>" per application)
+// so that slow-starting applications can be found.
+class LaunchTracker
+{
+public:
+    // the file is read when first called
+    static LaunchTracker & instance();
+
+    // Call before launching (with the StartupWMClass, if any), then call
+    // started() with the result.
+    int launching(const QString & appID, const QString & wmClass);
+    void started(int launch, bool ok, int pid);
+
+    // If false, no launch is waiting for a window, so there is no need
+    // to look up a new window's details. Launches that have timed out may
+    // still count until the next call to windowAdded().
+    bool hasPending() const { return !mLaunches.empty(); }
+    // call for each new window (pid is 0 if not known)
+    void windowAdded(int pid, const QStringList & names);
+
+private:
+    struct Stats
+    {
+        int launches = 0; // with a window found
+        int64_t totalMs = 0;
+        int64_t maxMs = 0;
+    };
+
+    struct Launch
+    {
+        int id;
+        QString appID;
+        QStringList names; // lower case
+        int pid;
+        int64_t startMs;
+    };
+
+    LaunchTracker();
+
+    void expire();
+    void write() const;
+
+    QByteArray mPath;
+    QElapsedTimer mClock;
+    int mLastID = 0;
+    std::vector<Launch> mLaunches; // oldest first
+    std::unordered_map<QString, Stats> mStats;
+};
+
+#endif
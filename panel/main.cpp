@@ -26,13 +26,13 @@
  *
  * END_COMMON_COPYRIGHT_HEADER */
 
+#include "launcher.h"
 #include "mainpanel.h"
 #include "resources.h"
 
 #include <LayerShellQt/shell.h>
 #include <QApplication>
-#include <QDebug>
-#include <glib.h>
+#include <optional>
 #include <signal.h>
 #include <thread>
 
@@ -47,7 +47,7 @@ static void signal_thread()
     QMetaObject::invokeMethod(qApp, &QApplication::quit, Qt::QueuedConnection);
 }
 
-// also used in resources.cpp
+// also used in launcher.cpp
 void restore_signals(void *) { sigprocmask(SIG_UNBLOCK, &signal_set, nullptr); }
 
 int main(int argc, char * argv[])
@@ -59,28 +59,25 @@ int main(int argc, char * argv[])
     sigaddset(&signal_set, SIGTERM);
     sigprocmask(SIG_BLOCK, &signal_set, nullptr);
 
-    QApplication app(argc, argv);
+    /* fork the launcher while still single-threaded and small */
+    Launcher::startHelper();
+
+    /* Scan applications while connecting to the display server. The
+     * QApplication is declared first so that it is destroyed last, after
+     * the actions and icons held by Resources. */
+    std::optional<QApplication> app;
+    Resources res;
+
+    app.emplace(argc, argv);
 
     /* monitor signals once qApp exists */
     std::thread(signal_thread).detach();
 
-    Resources res;
     MainPanel panel(res);
 
     // Launch commands once D-Bus services are registered
-    // Unset QT_WAYLAND_SHELL_INTEGRATION or else all launched
-    // Qt applications will use layer-shell, wanted or not
-    char ** env =
-        g_environ_unsetenv(g_get_environ(), "QT_WAYLAND_SHELL_INTEGRATION");
     for (auto & cmd : res.settings().launchCmds)
-    {
-        char ** args = g_strsplit(cmd.toUtf8(), " ", -1);
-        if (!g_spawn_async(nullptr, args, env, G_SPAWN_SEARCH_PATH,
-                           restore_signals, nullptr, nullptr, nullptr))
-            qWarning() << "Failed to launch" << cmd;
-        g_strfreev(args);
-    }
-    g_strfreev(env);
+        Launcher::launchCmd(cmd);
 
-    return app.exec();
+    return app->exec();
 }
@@ -28,36 +28,50 @@
 
 #include "mainmenu.h"
 #include "actionview.h"
+#include "launchhistory.h"
 #include "mainpanel.h"
 #include "resources.h"
+#include "searchlatency.h"
+#include "taskbar.h"
+#include "taskbutton.h"
 
+#include <QDebug>
+#include <QElapsedTimer>
 #include <QHBoxLayout>
 #include <QKeyEvent>
 #include <QLineEdit>
 #include <QMenu>
 #include <QResizeEvent>
+#include <QTimer>
 #include <QWidgetAction>
+#include <algorithm>
+#include <unordered_set>
 
-struct Category
-{
-    const char * icon;
-    const char * displayName;
-    const char * internalName;
-};
+// time to spend adding applications to the menu in each idle slice
+static const int populateSliceMs = 5;
+// actions of a category submenu are released after it is closed this long
+static const int releaseCategoryMs = 5 * 60 * 1000;
 
 class MainMenu : public QMenu
 {
 public:
     MainMenu(Resources & res, QWidget * parent);
 
+    void addWindow(TaskButton * button);
+
 protected:
+    bool event(QEvent * e) override;
     void keyPressEvent(QKeyEvent * e) override;
     void resizeEvent(QResizeEvent * e) override;
     void showEvent(QShowEvent *) override;
 
 private:
-    void populate(Resources & res);
-    void searchTextChanged(const QString & text);
+    void startPopulate(Resources & res);
+    void populateSlice(Resources & res);
+    void updateApps(Resources & res, const QStringList & appIDs);
+    void addApp(Resources & res, const QString & appID);
+    QMenu * getCategoryMenu(Resources & res, int index);
+    void showResults();
 
     QWidgetAction mSearchEditAction;
     QWidgetAction mSearchViewAction;
@@ -65,7 +79,14 @@ private:
     QHBoxLayout mSearchLayout;
     QLineEdit mSearchEdit;
     ActionView mSearchView;
-    bool mPopulated = false;
+    QAction * mSeparator = nullptr;
+    QMenu * mCategoryMenus[numMenuCategories] = {};
+    // IDs of the applications in each category, sorted by name (actions
+    // are added to the submenu only while it is shown or recently was)
+    QStringList mCategoryApps[numMenuCategories];
+    QStringList mPendingApps;
+    QTimer mPopulateTimer;
+    std::unique_ptr<SearchLatency> mLatency; // null unless measuring
 };
 
 MainMenu::MainMenu(Resources & res, QWidget * parent)
@@ -84,7 +105,21 @@ MainMenu::MainMenu(Resources & res, QWidget * parent)
     mSearchView.hide();
     mSearchViewAction.setVisible(false);
 
-    connect(this, &QMenu::aboutToShow, [this, &res]() { populate(res); });
+    mSeparator = addSeparator();
+    addAction(&mSearchViewAction);
+    addAction(&mSearchEditAction);
+
+    // a zero timeout means the slice runs once no other events are queued
+    mPopulateTimer.setSingleShot(true);
+    mPopulateTimer.setInterval(0);
+    connect(&mPopulateTimer, &QTimer::timeout,
+            [this, &res]() { populateSlice(res); });
+
+    // if still being populated, show what is there already
+    connect(this, &QMenu::aboutToShow, [this, &res]() {
+        if (!mPendingApps.isEmpty())
+            populateSlice(res);
+    });
     connect(this, &QMenu::aboutToHide, &mSearchEdit, &QLineEdit::clear);
     connect(this, &QMenu::hovered, [this](QAction * action) {
         if (action == &mSearchEditAction)
@@ -93,11 +128,43 @@ MainMenu::MainMenu(Resources & res, QWidget * parent)
             mSearchEdit.clearFocus();
     });
 
-    connect(&mSearchEdit, &QLineEdit::textChanged, this,
-            &MainMenu::searchTextChanged);
+    // connected first, since clearing the search is shown at once
+    mLatency = SearchLatency::create(this, &mSearchEdit);
+    if (mLatency)
+    {
+        auto latency = mLatency.get();
+        connect(&mSearchEdit, &QLineEdit::textChanged,
+                [latency]() { latency->textChanged(); });
+        connect(this, &QMenu::aboutToHide, [latency]() { latency->report(); });
+    }
+
+    connect(&mSearchEdit, &QLineEdit::textChanged, &mSearchView,
+            &ActionView::setSearchStr);
     connect(&mSearchEdit, &QLineEdit::returnPressed, &mSearchView,
             &ActionView::activateCurrent);
     connect(&mSearchView, &QListView::activated, this, &QMenu::hide);
+    mSearchView.setSearchIndex(res.searchIndex());
+    mSearchView.setRanking([](const QString & appID) {
+        return LaunchHistory::instance().score(appID);
+    });
+    mSearchView.setResultsChanged([this]() { showResults(); });
+
+    res.watchApps([this, &res](const QStringList & appIDs) {
+        updateApps(res, appIDs);
+    });
+
+    startPopulate(res);
+}
+
+bool MainMenu::event(QEvent * e)
+{
+    bool handled = QMenu::event(e);
+
+    // the whole menu (including the search view) is painted by now
+    if (e->type() == QEvent::UpdateRequest && mLatency)
+        mLatency->framePainted();
+
+    return handled;
 }
 
 void MainMenu::keyPressEvent(QKeyEvent * e)
@@ -120,56 +187,239 @@ void MainMenu::showEvent(QShowEvent *)
     mSearchEdit.setFocus(Qt::OtherFocusReason);
 }
 
-void MainMenu::populate(Resources & res)
+// Queues all applications to be added to the menu, pinned ones first and
+// then each category in order. They are added a slice at a time by
+// populateSlice(), though only pinned applications get actions then.
+void MainMenu::startPopulate(Resources & res)
+{
+    std::unordered_set<QString> added;
+    for (auto & appID : res.settings().pinnedMenuApps)
+    {
+        if (!res.findApp(appID))
+            qWarning() << "Unknown application" << appID;
+        else if (added.insert(appID).second)
+            mPendingApps.append(appID);
+    }
+
+    for (int i = 0; i < numMenuCategories; i++)
+    {
+        for (auto app : res.getCategory(i))
+        {
+            // only add if not already in another category
+            if (added.insert(app->id()).second)
+                mPendingApps.append(app->id());
+        }
+    }
+
+    mPopulateTimer.start();
+}
+
+void MainMenu::populateSlice(Resources & res)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    while (!mPendingApps.isEmpty() && !timer.hasExpired(populateSliceMs))
+        addApp(res, mPendingApps.takeFirst());
+
+    if (!mPendingApps.isEmpty())
+        mPopulateTimer.start();
+}
+
+void MainMenu::updateApps(Resources & res, const QStringList & appIDs)
+{
+    // added below if still pending
+    for (auto & appID : appIDs)
+        mPendingApps.removeAll(appID);
+
+    // Actions of removed applications are already gone. Remove those of
+    // modified applications too, since their category may have changed.
+    for (auto & appID : appIDs)
+    {
+        for (auto & categoryApps : mCategoryApps)
+            categoryApps.removeAll(appID);
+
+        // an action never created is not in any menu
+        auto app = res.findApp(appID);
+        auto action = app ? app->action() : nullptr;
+        if (!action)
+            continue;
+
+        removeAction(action);
+        for (auto menu : mCategoryMenus)
+        {
+            if (menu)
+                menu->removeAction(action);
+        }
+    }
+
+    // set first, so that any search run again below uses it
+    mSearchView.setSearchIndex(res.searchIndex());
+    mSearchView.removeItems(appIDs);
+
+    for (auto & appID : appIDs)
+    {
+        addApp(res, appID);
+
+        // if not re-added anywhere, the action is not needed for now
+        auto app = res.findApp(appID);
+        if (app)
+            app->releaseAction();
+    }
+
+    for (int i = 0; i < numMenuCategories; i++)
+    {
+        if (mCategoryMenus[i] && mCategoryApps[i].isEmpty())
+        {
+            delete mCategoryMenus[i];
+            mCategoryMenus[i] = nullptr;
+        }
+    }
+}
+
+void MainMenu::addApp(Resources & res, const QString & appID)
 {
-    if (mPopulated)
+    auto app = res.findApp(appID);
+    if (!app)
         return;
 
-    static const Category categories[] = {
-        {"applications-development", "Development", "Development"},
-        {"applications-science", "Education", "Education"},
-        {"applications-games", "Games", "Game"},
-        {"applications-graphics", "Graphics", "Graphics"},
-        {"applications-multimedia", "Multimedia", "AudioVideo"},
-        {"applications-internet", "Network", "Network"},
-        {"applications-office", "Office", "Office"},
-        {"preferences-desktop", "Settings", "Settings"},
-        {"applications-system", "System", "System"},
-        {"applications-accessories", "Utility", "Utility"}};
+    auto & pinnedApps = res.settings().pinnedMenuApps;
+    int pinnedIdx = pinnedApps.indexOf(appID);
 
-    std::unordered_set<QString> added;
-    for (auto app : res.settings().pinnedMenuApps)
+    if (pinnedIdx >= 0)
+    {
+        // keep pinned applications in the configured order
+        QAction * before = mSeparator;
+        auto menuActions = actions();
+        for (int i = pinnedIdx + 1; i < pinnedApps.size(); i++)
+        {
+            auto nextApp = res.findApp(pinnedApps[i]);
+            auto nextAction = nextApp ? nextApp->action() : nullptr;
+            if (nextAction && menuActions.contains(nextAction))
+            {
+                before = nextAction;
+                break;
+            }
+        }
+
+        auto action = app->getAction();
+        action->setVisible(mSearchEdit.text().trimmed().isEmpty());
+        insertAction(before, action);
+        return;
+    }
+
+    // as in Resources::getCategory(), the first matching category wins
+    for (int i = 0; i < numMenuCategories; i++)
     {
-        auto action = res.getAction(app);
-        if (action)
+        if (!(app->categoryMask() & (1u << i)))
+            continue;
+
+        auto & name = app->data().displayName;
+        auto & categoryApps = mCategoryApps[i];
+        auto pos = std::upper_bound(
+            categoryApps.begin(), categoryApps.end(), name,
+            [&res](const QString & str, const QString & otherID) {
+                auto other = res.findApp(otherID);
+                return other && str.compare(other->data().displayName,
+                                            Qt::CaseInsensitive) < 0;
+            });
+
+        int index = pos - categoryApps.begin();
+        categoryApps.insert(index, appID);
+
+        // add the action only if the submenu already has the others
+        auto menu = getCategoryMenu(res, i);
+        if (!menu->isEmpty())
         {
-            addAction(action);
-            added.insert(app);
+            auto menuActions = menu->actions();
+            menu->insertAction(menuActions.value(index), app->getAction());
         }
+
+        mSearchView.addItem(appID, name, [&res, appID]() -> QAction * {
+            auto app = res.findApp(appID);
+            return app ? app->getAction() : nullptr;
+        });
+
+        return;
     }
+}
 
-    addSeparator();
+// The window is found by its title (but not by other fields, or launch
+// history), and its item is updated whenever the title changes.
+void MainMenu::addWindow(TaskButton * button)
+{
+    auto action = button->action();
+    auto id = QString("window:%1").arg((quintptr)button, 0, 16);
+    mSearchView.addItem(id, action->text(), [action]() { return action; });
+
+    connect(action, &QAction::changed, this, [this, action, id]() {
+        mSearchView.setItemText(id, action->text());
+    });
+    connect(button, &QObject::destroyed, this,
+            [this, id]() { mSearchView.removeItems({id}); });
+}
+
+QMenu * MainMenu::getCategoryMenu(Resources & res, int index)
+{
+    if (mCategoryMenus[index])
+        return mCategoryMenus[index];
 
-    for (auto & category : categories)
+    // insert before the next category, or else before the search view
+    QAction * before = &mSearchViewAction;
+    for (int i = index + 1; i < numMenuCategories; i++)
     {
-        auto apps = res.getCategory(category.internalName, added);
-        if (!apps.isEmpty())
+        if (mCategoryMenus[i])
         {
-            auto icon = res.getIcon(category.icon);
-            addMenu(icon, category.displayName)->addActions(apps);
-            mSearchView.addActions(apps);
+            before = mCategoryMenus[i]->menuAction();
+            break;
         }
     }
 
-    addAction(&mSearchViewAction);
-    addAction(&mSearchEditAction);
+    auto & category = menuCategories[index];
+    auto menu = new QMenu(category.displayName, this);
+    menu->setIcon(Resources::getIcon(category.icon));
+    menu->menuAction()->setVisible(mSearchEdit.text().trimmed().isEmpty());
+    insertMenu(before, menu);
+
+    auto releaseTimer = new QTimer(menu);
+    releaseTimer->setSingleShot(true);
+    releaseTimer->setInterval(releaseCategoryMs);
+
+    connect(menu, &QMenu::aboutToShow, releaseTimer, &QTimer::stop);
+    connect(menu, &QMenu::aboutToHide, releaseTimer,
+            qOverload<>(&QTimer::start));
+
+    // create the actions only when the submenu is first shown
+    connect(menu, &QMenu::aboutToShow, [this, &res, menu, index]() {
+        if (!menu->isEmpty())
+            return;
+
+        for (auto & appID : mCategoryApps[index])
+        {
+            auto app = res.findApp(appID);
+            if (app)
+                menu->addAction(app->getAction());
+        }
+    });
+
+    connect(releaseTimer, &QTimer::timeout, [this, &res, menu, index]() {
+        menu->clear();
+        for (auto & appID : mCategoryApps[index])
+        {
+            auto app = res.findApp(appID);
+            if (app)
+                app->releaseAction();
+        }
+    });
 
-    mPopulated = true;
+    mCategoryMenus[index] = menu;
+    return menu;
 }
 
-void MainMenu::searchTextChanged(const QString & text)
+// called once the results of a search are ready (or it was cleared)
+void MainMenu::showResults()
 {
-    bool shown = !text.isEmpty();
+    bool shown = !mSearchEdit.text().trimmed().isEmpty();
 
     for (auto const & action : actions())
     {
@@ -177,12 +427,12 @@ void MainMenu::searchTextChanged(const QString & text)
             action->setVisible(!shown);
     }
 
-    if (shown)
-        mSearchView.setSearchStr(text);
-
     mSearchView.setVisible(shown);
     mSearchViewAction.setVisible(shown);
 
+    if (mLatency)
+        mLatency->resultsShown();
+
     // force re-layout
     QEvent e(QEvent::StyleChange);
     event(&e);
@@ -191,14 +441,20 @@ void MainMenu::searchTextChanged(const QString & text)
 MainMenuButton::MainMenuButton(Resources & res, MainPanel * panel)
     : QToolButton(panel)
 {
-    auto menu = new MainMenu(res, this);
-    panel->registerMenu(menu);
+    mMenu = new MainMenu(res, this);
+    panel->registerMenu(mMenu);
 
     setAutoRaise(true);
     setIcon(res.getIcon(res.settings().menuIcon));
-    setMenu(menu);
+    setMenu(mMenu);
     setPopupMode(InstantPopup);
     setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Expanding);
     setStyleSheet("QToolButton::menu-indicator { image: none; }");
     setToolButtonStyle(Qt::ToolButtonIconOnly);
 }
+
+void MainMenuButton::searchWindows(TaskBar & taskBar)
+{
+    taskBar.watchWindows(
+        [this](TaskButton * button) { mMenu->addWindow(button); });
+}
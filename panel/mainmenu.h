@@ -31,13 +31,21 @@
 
 #include <QToolButton>
 
+class MainMenu;
 class MainPanel;
 class Resources;
+class TaskBar;
 
 class MainMenuButton : public QToolButton
 {
 public:
     explicit MainMenuButton(Resources & res, MainPanel * panel);
+
+    // lists the open windows in the search results too
+    void searchWindows(TaskBar & taskBar);
+
+private:
+    MainMenu * mMenu;
 };
 
 #endif
@@ -54,9 +54,13 @@ MainPanel::MainPanel(Resources & res) : mLayout(this)
     mLayout.setContentsMargins(QMargins());
     mLayout.setSpacing(logicalDpiX() / 24);
 
-    mLayout.addWidget(new MainMenuButton(res, this));
+    auto menuButton = new MainMenuButton(res, this);
+    auto taskBar = new TaskBar(res, this);
+    menuButton->searchWindows(*taskBar);
+
+    mLayout.addWidget(menuButton);
     mLayout.addWidget(new QuickLaunch(res, this));
-    mLayout.addWidget(new TaskBar(res, this));
+    mLayout.addWidget(taskBar);
     mLayout.addWidget(new StatusNotifier(this));
     mLayout.addWidget(new ClockLabel(this));
 
@@ -39,6 +39,26 @@ QuickLaunch::QuickLaunch(Resources & res, QWidget * parent)
     mLayout.setContentsMargins(QMargins());
     mLayout.setSpacing(0);
 
+    addButtons(res);
+
+    // A removed application's action is deleted (leaving its button
+    // blank), so rebuild the buttons if any of the applications change.
+    res.watchApps([this, &res](const QStringList & appIDs) {
+        for (auto & app : res.settings().quickLaunchApps)
+        {
+            if (appIDs.contains(app))
+            {
+                qDeleteAll(mButtons);
+                mButtons.clear();
+                addButtons(res);
+                return;
+            }
+        }
+    });
+}
+
+void QuickLaunch::addButtons(Resources & res)
+{
     for (auto app : res.settings().quickLaunchApps)
     {
         auto action = res.getAction(app);
@@ -50,5 +70,6 @@ QuickLaunch::QuickLaunch(Resources & res, QWidget * parent)
         button->setDefaultAction(action);
         button->setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Expanding);
         mLayout.addWidget(button);
+        mButtons.append(button);
     }
 }
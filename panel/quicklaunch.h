@@ -33,6 +33,7 @@
 #include <QHBoxLayout>
 #include <QWidget>
 
+class QToolButton;
 class Resources;
 
 class QuickLaunch : public QWidget
@@ -41,7 +42,10 @@ public:
     explicit QuickLaunch(Resources & res, QWidget * parent);
 
 private:
+    void addButtons(Resources & res);
+
     QHBoxLayout mLayout;
+    QList<QToolButton *> mButtons;
 };
 
 #endif
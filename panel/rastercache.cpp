@@ -0,0 +1,554 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * qmpanel - a minimal Qt-based desktop panel
+ *
+ * Copyright: 2026 John Lindgren
+ * Authors:
+ *   John Lindgren <john@jlindgren.net>
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "rastercache.h"
+
+#include <QApplication>
+#include <QDebug>
+#include <QIconEngine>
+#include <QImageReader>
+#include <QPainter>
+#include <QTimer>
+#include <condition_variable>
+#include <glib.h>
+#include <mutex>
+#include <string.h>
+#include <sys/stat.h>
+#include <thread>
+
+// Image data is ARGB32 premultiplied, in native byte order and without
+// padding between rows. Paths are offsets into the string table, which
+// follows the image table; image data offsets are from the start of the
+// file. Bump the version whenever the layout changes.
+static const char cacheMagic[8] = {'Q', 'M', 'P', 'I', 'C', 'O', 'N', '\0'};
+static const uint32_t cacheVersion = 1;
+
+// total size of the images kept (see dropUnused())
+static const size_t maxDataSize = 32 << 20;
+
+struct CacheHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t imageCount;
+    uint32_t stringsSize;
+    uint32_t reserved;
+};
+
+struct CacheImage
+{
+    int64_t mtimeSec, mtimeNsec;
+    double scale;
+    uint64_t offset;
+    uint32_t path;
+    int32_t requestWidth, requestHeight;
+    int32_t width, height;
+    uint32_t reserved;
+};
+
+// Renders the SVG file (via a normal QIcon, created only when first
+// needed) only if the cache does not already have the requested size.
+class CachedIconEngine : public QIconEngine
+{
+public:
+    explicit CachedIconEngine(const IconFiles & files) : mFiles(files) {}
+
+    QIconEngine * clone() const override
+    {
+        return new CachedIconEngine(*this);
+    }
+
+    bool isNull() override { return false; }
+
+    QSize actualSize(const QSize & size, QIcon::Mode, QIcon::State) override
+    {
+        return size;
+    }
+
+    QList<QSize> availableSizes(QIcon::Mode mode, QIcon::State state) override
+    {
+        return icon().availableSizes(mode, state);
+    }
+
+    void paint(QPainter * painter, const QRect & rect, QIcon::Mode mode,
+               QIcon::State state) override
+    {
+        qreal scale = painter->device()->devicePixelRatio();
+        auto pixmap = scaledPixmap(rect.size(), mode, state, scale);
+        painter->drawPixmap(rect, pixmap);
+    }
+
+    QPixmap pixmap(const QSize & size, QIcon::Mode mode,
+                   QIcon::State state) override
+    {
+        return scaledPixmap(size, mode, state, 1);
+    }
+
+    QPixmap scaledPixmap(const QSize & size, QIcon::Mode mode,
+                         QIcon::State state, qreal scale) override;
+
+private:
+    const QIcon & icon();
+
+    IconFiles mFiles;
+    QIcon mIcon;
+    RasterCache::Source mSource = {};
+    bool mSourceValid = false;
+};
+
+const QIcon & CachedIconEngine::icon()
+{
+    if (mIcon.isNull())
+        mIcon = mFiles.load();
+
+    return mIcon;
+}
+
+QPixmap CachedIconEngine::scaledPixmap(const QSize & size, QIcon::Mode mode,
+                                       QIcon::State state, qreal scale)
+{
+    // the active mode (highlighted menu items) looks the same as normal
+    if ((mode != QIcon::Normal && mode != QIcon::Active) ||
+        state != QIcon::Off)
+        return icon().pixmap(size, scale, mode, state);
+
+    if (mSource.path.isEmpty())
+        mSourceValid = RasterCache::getSource(mFiles.scalablePath, mSource);
+
+    if (!mSourceValid)
+        return icon().pixmap(size, scale);
+
+    auto image = RasterCache::instance().get(mSource, size, scale, [&]() {
+        return icon().pixmap(size, scale).toImage();
+    });
+
+    auto pixmap = QPixmap::fromImage(image);
+    pixmap.setDevicePixelRatio(scale);
+    return pixmap;
+}
+
+// Reads icon files (scaled to the requested size) in worker threads.
+// The newest job is taken first, since it is the most likely to be on
+// screen (e.g. a submenu that was just opened).
+class IconRenderer : public QObject
+{
+public:
+    using Callback = std::function<void(const QImage &)>;
+
+    static IconRenderer & instance();
+
+    // callback is called on the GUI thread
+    void add(const QString & path, const QSize & size, Callback callback);
+
+private:
+    struct Job
+    {
+        QString path;
+        QSize size;
+        Callback callback;
+    };
+
+    explicit IconRenderer(QObject * parent) : QObject(parent) {}
+    ~IconRenderer();
+
+    void run();
+
+    std::mutex mMutex;
+    std::condition_variable mWake;
+    std::vector<Job> mJobs;
+    std::vector<std::thread> mThreads;
+    bool mQuit = false;
+};
+
+static IconRenderer * iconRenderer; // owned by qApp
+
+IconRenderer & IconRenderer::instance()
+{
+    if (!iconRenderer)
+        iconRenderer = new IconRenderer(qApp);
+
+    return *iconRenderer;
+}
+
+// called from ~QApplication, so no callbacks can be queued after this
+IconRenderer::~IconRenderer()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mQuit = true;
+    }
+
+    mWake.notify_all();
+    for (auto & thread : mThreads)
+        thread.join();
+
+    iconRenderer = nullptr;
+}
+
+void IconRenderer::add(const QString & path, const QSize & size,
+                       Callback callback)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mJobs.push_back({path, size, std::move(callback)});
+    }
+
+    // rendering SVG is CPU-bound, but leave a core for the GUI thread
+    size_t maxThreads = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    if (mThreads.size() < std::min<size_t>(maxThreads, 4))
+        mThreads.emplace_back([this]() { run(); });
+    else
+        mWake.notify_one();
+}
+
+void IconRenderer::run()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    while (true)
+    {
+        mWake.wait(lock, [this]() { return mQuit || !mJobs.empty(); });
+        if (mQuit)
+            return;
+
+        auto job = std::move(mJobs.back());
+        mJobs.pop_back();
+        lock.unlock();
+
+        // keep the aspect ratio, as QIcon does
+        QImageReader reader(job.path);
+        auto size = reader.size();
+        if (size.isValid())
+            size.scale(job.size, Qt::KeepAspectRatio);
+        else
+            size = job.size;
+
+        reader.setScaledSize(size);
+        auto image =
+            reader.read().convertToFormat(QImage::Format_ARGB32_Premultiplied);
+
+        QMetaObject::invokeMethod(
+            this,
+            [callback = std::move(job.callback), image]() { callback(image); },
+            Qt::QueuedConnection);
+
+        lock.lock();
+    }
+}
+
+RasterCache & RasterCache::instance()
+{
+    static RasterCache cache;
+    return cache;
+}
+
+QIcon RasterCache::makeIcon(const IconFiles & files)
+{
+    if (files.scalablePath.isEmpty())
+        return files.load();
+
+    return QIcon(new CachedIconEngine(files));
+}
+
+RasterCache::RasterCache()
+    : mPath(QByteArray(g_get_user_cache_dir()) + "/qmpanel/icons.cache"),
+      mFile(nullptr, g_mapped_file_unref)
+{
+    read();
+}
+
+RasterCache::~RasterCache()
+{
+    if (mWritePending)
+        write();
+}
+
+bool RasterCache::getSource(const QString & path, Source & source)
+{
+    struct stat st;
+    source.path = path.toUtf8();
+    if (stat(source.path, &st) < 0)
+        return false;
+
+    source.mtimeSec = st.st_mtim.tv_sec;
+    source.mtimeNsec = st.st_mtim.tv_nsec;
+    return true;
+}
+
+QByteArray RasterCache::makeKey(const Source & source, const QSize & size,
+                                qreal scale)
+{
+    return source.path + '\0' + QByteArray::number(source.mtimeSec) + '.' +
+           QByteArray::number(source.mtimeNsec) + '\0' +
+           QByteArray::number(size.width()) + 'x' +
+           QByteArray::number(size.height()) + '@' +
+           QByteArray::number(scale);
+}
+
+QImage RasterCache::get(const Source & source, const QSize & size,
+                        qreal scale, const std::function<QImage()> & render)
+{
+    auto key = makeKey(source, size, scale);
+    auto iter = mEntries.find(key);
+    if (iter != mEntries.end())
+    {
+        iter->second.used = true;
+        return iter->second.image;
+    }
+
+    auto image = render().convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    size_t bytes = (size_t)image.width() * image.height() * 4;
+    if (!image.isNull() && mDataSize + bytes > maxDataSize)
+        dropUnused();
+    if (image.isNull() || mDataSize + bytes > maxDataSize)
+        return image;
+
+    mEntries.emplace(key, Entry{source, size, scale, image, true});
+    mDataSize += bytes;
+
+    // more images are usually rendered soon after (e.g. a whole menu)
+    if (!mWritePending)
+    {
+        mWritePending = true;
+        QTimer::singleShot(2000, qApp, [this]() {
+            if (mWritePending)
+                write();
+        });
+    }
+
+    return image;
+}
+
+bool RasterCache::prerender(const IconFiles & files, const QSize & size,
+                            qreal scale, std::function<void()> done)
+{
+    Source source;
+    if (files.scalablePath.isEmpty() ||
+        !getSource(files.scalablePath, source))
+        return false;
+
+    auto key = makeKey(source, size, scale);
+    auto iter = mEntries.find(key);
+    if (iter != mEntries.end())
+    {
+        iter->second.used = true;
+        return false;
+    }
+
+    auto & callbacks = mRendering[key];
+    callbacks.push_back(std::move(done));
+    if (callbacks.size() > 1)
+        return true; // already being rendered
+
+    // as in QIcon, prefer a PNG file of exactly the right size
+    QSize pixelSize = size * scale;
+    auto path = files.scalablePath;
+    for (auto & [sizedPath, sizedSize] : files.sizedPaths)
+    {
+        if (pixelSize == QSize(sizedSize, sizedSize))
+            path = sizedPath;
+    }
+
+    auto finish = [this, key, source, size, scale](const QImage & image) {
+        // if rendering failed, the icon will try again when painted
+        if (!image.isNull())
+            get(source, size, scale, [&image]() { return image; });
+
+        auto callbacks = std::move(mRendering[key]);
+        mRendering.erase(key);
+        for (auto & callback : callbacks)
+            callback();
+    };
+
+    IconRenderer::instance().add(path, pixelSize, finish);
+    return true;
+}
+
+// Stale images (e.g. of another icon theme or size) would otherwise fill
+// the cache for good, since only those of modified files are dropped.
+void RasterCache::dropUnused()
+{
+    for (auto iter = mEntries.begin(); iter != mEntries.end();)
+    {
+        if (iter->second.used)
+        {
+            ++iter;
+            continue;
+        }
+
+        auto & image = iter->second.image;
+        mDataSize -= (size_t)image.width() * image.height() * 4;
+        iter = mEntries.erase(iter);
+    }
+}
+
+void RasterCache::read()
+{
+    mFile.reset(g_mapped_file_new(mPath, false, nullptr));
+    if (!mFile)
+        return;
+
+    auto data = g_mapped_file_get_contents(mFile.get());
+    size_t size = g_mapped_file_get_length(mFile.get());
+    if (size < sizeof(CacheHeader))
+        return;
+
+    auto header = (const CacheHeader *)data;
+    if (memcmp(header->magic, cacheMagic, sizeof cacheMagic) ||
+        header->version != cacheVersion)
+        return;
+
+    size_t tablesSize = sizeof(CacheHeader) +
+                        sizeof(CacheImage) * (size_t)header->imageCount;
+    if (tablesSize + header->stringsSize > size)
+        return;
+
+    auto cacheImages = (const CacheImage *)(header + 1);
+    auto strings = data + tablesSize;
+    size_t dataStart = tablesSize + header->stringsSize;
+
+    // the string table must end with a null terminator
+    if (header->stringsSize && strings[header->stringsSize - 1])
+        return;
+
+    for (uint32_t i = 0; i < header->imageCount; i++)
+    {
+        auto & cacheImage = cacheImages[i];
+        int width = cacheImage.width, height = cacheImage.height;
+        size_t bytes = (size_t)width * height * 4;
+
+        if (cacheImage.path >= header->stringsSize || width <= 0 ||
+            height <= 0 || width > 4096 || height > 4096 ||
+            cacheImage.offset < dataStart || cacheImage.offset % 4 ||
+            cacheImage.offset > size || bytes > size - cacheImage.offset)
+        {
+            qWarning() << "Ignoring corrupt cache" << mPath;
+            mEntries.clear();
+            mDataSize = 0;
+            return;
+        }
+
+        // refers directly to the mapped file (no copy)
+        QImage image((const uchar *)data + cacheImage.offset, width, height,
+                     width * 4, QImage::Format_ARGB32_Premultiplied);
+
+        Source source = {QByteArray(strings + cacheImage.path),
+                         cacheImage.mtimeSec, cacheImage.mtimeNsec};
+        QSize requestSize(cacheImage.requestWidth, cacheImage.requestHeight);
+
+        mEntries.emplace(makeKey(source, requestSize, cacheImage.scale),
+                         Entry{source, requestSize, cacheImage.scale, image});
+        mDataSize += bytes;
+    }
+}
+
+void RasterCache::write()
+{
+    mWritePending = false;
+
+    // leave out images of files that were since modified or removed
+    std::unordered_map<QByteArray, std::pair<int64_t, int64_t>> mtimes;
+    std::vector<const Entry *> entries;
+
+    for (auto & pair : mEntries)
+    {
+        auto & source = pair.second.source;
+        auto result = mtimes.try_emplace(source.path, -1, -1);
+        if (result.second)
+        {
+            struct stat st;
+            if (stat(source.path, &st) == 0)
+                result.first->second = {st.st_mtim.tv_sec, st.st_mtim.tv_nsec};
+        }
+
+        if (result.first->second ==
+            std::make_pair(source.mtimeSec, source.mtimeNsec))
+            entries.push_back(&pair.second);
+    }
+
+    QByteArray strings;
+    std::unordered_map<QByteArray, uint32_t> stringOffsets;
+
+    auto addString = [&](const QByteArray & str) {
+        auto result = stringOffsets.try_emplace(str, strings.size());
+        if (result.second)
+            strings.append(str).append('\0');
+        return result.first->second;
+    };
+
+    std::vector<CacheImage> cacheImages;
+    for (auto entry : entries)
+    {
+        cacheImages.push_back({entry->source.mtimeSec,
+                               entry->source.mtimeNsec, entry->scale, 0,
+                               addString(entry->source.path),
+                               entry->size.width(), entry->size.height(),
+                               entry->image.width(), entry->image.height(),
+                               0});
+    }
+
+    CacheHeader header = {};
+    memcpy(header.magic, cacheMagic, sizeof cacheMagic);
+    header.version = cacheVersion;
+    header.imageCount = cacheImages.size();
+    header.stringsSize = strings.size();
+
+    // image data starts on a 16-byte boundary
+    size_t offset = sizeof header + sizeof(CacheImage) * cacheImages.size() +
+                    strings.size();
+    size_t padding = (16 - offset % 16) % 16;
+    offset += padding;
+
+    for (auto & cacheImage : cacheImages)
+    {
+        cacheImage.offset = offset;
+        offset += (size_t)cacheImage.width * cacheImage.height * 4;
+    }
+
+    QByteArray contents;
+    contents.reserve(offset);
+    contents.append((const char *)&header, sizeof header);
+    contents.append((const char *)cacheImages.data(),
+                    sizeof(CacheImage) * cacheImages.size());
+    contents.append(strings);
+    contents.append(padding, '\0');
+
+    for (auto entry : entries)
+    {
+        auto & image = entry->image;
+        for (int y = 0; y < image.height(); y++)
+            contents.append((const char *)image.constScanLine(y),
+                            image.width() * 4);
+    }
+
+    // g_file_set_contents() writes to a temporary file and renames it,
+    // so the file mapped by this or another panel process is unchanged
+    CharPtr dir(g_path_get_dirname(mPath), g_free);
+    g_mkdir_with_parents(dir.get(), 0700);
+    if (!g_file_set_contents(mPath, contents.constData(), contents.size(),
+                             nullptr))
+        qWarning() << "Failed to write" << mPath;
+}
@@ -0,0 +1,100 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * qmpanel - a minimal Qt-based desktop panel
+ *
+ * Copyright: 2026 John Lindgren
+ * Authors:
+ *   John Lindgren <john@jlindgren.net>
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef RASTERCACHE_H
+#define RASTERCACHE_H
+
+#include "icontheme.h"
+#include "utils.h"
+
+#include <QImage>
+#include <functional>
+#include <vector>
+#include <unordered_map>
+
+// Rendered images of SVG icons, stored under $XDG_CACHE_HOME so that a
+// warm start does not need to parse any SVG file. Images are keyed by
+// source file, modification time, size and device pixel ratio, and are
+// used directly from the mapped file. New images are written out after
+// a short delay. Once the cache is full, images not used since it was
+// read are dropped to make room.
+class RasterCache
+{
+public:
+    struct Source
+    {
+        QByteArray path;
+        int64_t mtimeSec, mtimeNsec;
+    };
+
+    static RasterCache & instance();
+
+    // returns an icon that renders its SVG file only on cache misses
+    // (icons without an SVG file are simply loaded)
+    static QIcon makeIcon(const IconFiles & files);
+
+    static bool getSource(const QString & path, Source & source);
+
+    QImage get(const Source & source, const QSize & size, qreal scale,
+               const std::function<QImage()> & render);
+
+    // Renders the SVG file of an icon in a worker thread, unless the
+    // cache already has it at the given size (then returns false).
+    // Otherwise done() is called on the GUI thread once it is cached.
+    bool prerender(const IconFiles & files, const QSize & size, qreal scale,
+                   std::function<void()> done);
+
+private:
+    struct Entry
+    {
+        Source source;
+        QSize size;
+        qreal scale;
+        QImage image;
+        bool used = false; // since the cache was read
+    };
+
+    RasterCache();
+    ~RasterCache();
+
+    static QByteArray makeKey(const Source & source, const QSize & size,
+                              qreal scale);
+
+    void dropUnused();
+    void read();
+    void write();
+
+    QByteArray mPath;
+    AutoPtr<GMappedFile> mFile; // must outlive mEntries
+    std::unordered_map<QByteArray, Entry> mEntries;
+    // callbacks waiting for images being rendered
+    std::unordered_map<QByteArray, std::vector<std::function<void()>>>
+        mRendering;
+    size_t mDataSize = 0;
+    bool mWritePending = false;
+};
+
+#endif
@@ -25,92 +25,155 @@
  * END_COMMON_COPYRIGHT_HEADER */
 
 #include "resources.h"
+#include "appcache.h"
+#include "appnamemap.h"
+#include "desktopfile.h"
+#include "icontheme.h"
+#include "launcher.h"
+#include "launchhistory.h"
+#include "launchtracker.h"
+#include "rastercache.h"
+#include "searchindex.h"
 
 #include <QAction>
+#include <QApplication>
 #include <QDebug>
 #include <QFileInfo>
-#include <QRegularExpression>
+#include <QFileSystemWatcher>
+#include <QPointer>
+#include <QSet>
+#include <QStyle>
+#include <QTimer>
+#include <string.h>
 
 #undef signals
-#include <gio/gdesktopappinfo.h>
 #include <gio/gio.h>
 
-AppInfo::AppInfo(GDesktopAppInfo * info)
-    : mInfo((GDesktopAppInfo *)g_object_ref(info), g_object_unref)
+AppInfo::AppInfo(const QString & id, Data && data)
+    : mID(id), mData(std::move(data))
 {
 }
 
-QStringList AppInfo::categories() const
+void AppInfo::update(Data && data)
 {
-    if (!g_app_info_should_show((GAppInfo *)mInfo.get()))
-        return QStringList();
+    mData = std::move(data);
 
-    return QString(g_desktop_app_info_get_categories(mInfo.get()))
-        .split(';', Qt::SkipEmptyParts);
+    if (mAction)
+    {
+        updateIcon();
+        mAction->setText(mData.displayName);
+    }
 }
 
 QIcon AppInfo::getIcon() const
 {
-    auto gicon = g_app_info_get_icon((GAppInfo *)mInfo.get());
-    if (!gicon)
-        return QIcon();
-
-    CharPtr name(g_icon_to_string(gicon), g_free);
-    return name ? Resources::getIcon(QString(name)) : QIcon();
+    return mData.icon.isEmpty() ? QIcon() : Resources::getIcon(mData.icon);
 }
 
-QString AppInfo::getExecutable() const
+QAction * AppInfo::getAction()
 {
-    return g_app_info_get_executable((GAppInfo *)mInfo.get());
+    if (mAction)
+        return mAction.get();
+
+    auto action = new QAction(mData.displayName);
+    QObject::connect(action, &QAction::triggered, [this]() { launch(); });
+
+    mAction.reset(action);
+    updateIcon();
+    return action;
 }
 
-QString AppInfo::getStartupWMClass() const
+// The icon is rendered in the background if needed. Menus and the search
+// view use the small icon size, so that is the size rendered.
+void AppInfo::updateIcon()
 {
-    return g_desktop_app_info_get_startup_wm_class(mInfo.get());
+    if (mData.icon.isEmpty())
+    {
+        mAction->setIcon(QIcon());
+        return;
+    }
+
+    int size = QApplication::style()->pixelMetric(QStyle::PM_SmallIconSize);
+    QPointer<QAction> action = mAction.get();
+    auto name = mData.icon;
+
+    mAction->setIcon(Resources::getIconAsync(
+        name, QSize(size, size), [this, action, name](const QIcon & icon) {
+            // skip if the action was deleted or the icon has changed
+            if (action && mData.icon == name)
+                action->setIcon(icon);
+        }));
 }
 
-QAction * AppInfo::getAction()
+void AppInfo::releaseAction()
 {
-    if (mAction)
-        return mAction.get();
+    if (mAction && mAction->associatedObjects().isEmpty())
+        mAction.reset();
+}
 
-    auto info = mInfo.get();
-    auto action =
-        new QAction(getIcon(), g_app_info_get_display_name((GAppInfo *)info));
-
-    QObject::connect(action, &QAction::triggered, [info]() {
-        // Unset QT_WAYLAND_SHELL_INTEGRATION or else all launched
-        // Qt applications will use layer-shell, wanted or not
-        auto context = g_app_launch_context_new();
-        g_app_launch_context_unsetenv(context, "QT_WAYLAND_SHELL_INTEGRATION");
-        if (!g_desktop_app_info_launch_uris_as_manager(
-                info, nullptr, context, G_SPAWN_SEARCH_PATH, restore_signals,
-                nullptr, nullptr, nullptr, nullptr))
-            qWarning() << "Failed to launch"
-                       << g_app_info_get_id((GAppInfo *)info);
-        g_object_unref(context);
+void AppInfo::launch()
+{
+    // the AppInfo may be gone by the time the helper replies
+    auto appID = mID;
+    int launch =
+        LaunchTracker::instance().launching(appID, mData.startupWMClass);
+
+    Launcher::launchApp(appID, [appID, launch](bool started, int pid) {
+        LaunchTracker::instance().started(launch, started, pid);
+        if (started)
+            LaunchHistory::instance().record(appID);
     });
-
-    mAction.reset(action);
-    return action;
 }
 
-QIcon Resources::getIcon(const QString & name)
+Resources::Resources()
+    : mLoader(std::async(std::launch::async, [this]() {
+          mAppScan = std::make_unique<AppScan>();
+          mAppInfos = loadAppInfos(*mAppScan);
+          mAppNameMap = makeAppNameMap(mAppInfos);
+          mSearchIndex = makeSearchIndex(mAppInfos);
+          mSettings = loadSettings();
+          LaunchHistory::instance(); // read the log now too
+      }))
 {
-    if (g_path_is_absolute(name.toUtf8()))
-        return QIcon(name);
+}
 
-    auto icon = QIcon::fromTheme(name);
-    if (!icon.isNull())
-        return icon;
+Resources::~Resources() = default;
+
+// searched (without a theme) if an icon is not found otherwise
+static const char * const fallbackIconDirs[] = {"/usr/share/icons",
+                                                "/usr/share/pixmaps"};
 
-    for (auto dir : {"/usr/share/icons", "/usr/share/pixmaps"})
+static QIcon findIcon(const QString & name, IconFiles & files)
+{
+    // If some theme has no cache, only an exact match is taken from the
+    // caches, since QIcon::fromTheme() might find the full name in that
+    // theme (and does its own fallback).
+    auto & theme = IconTheme::current();
+    files = theme.lookup(name, theme.isComplete());
+    if (!files.isEmpty())
+        return RasterCache::makeIcon(files);
+
+    if (!theme.isComplete())
+    {
+        auto icon = QIcon::fromTheme(name);
+        if (!icon.isNull())
+            return icon;
+    }
+
+    for (auto dir : fallbackIconDirs)
     {
         for (auto ext : {"svg", "png", "xpm"})
         {
             auto path = QString("%1/%2.%3").arg(dir, name, ext);
-            if (g_file_test(path.toUtf8(), G_FILE_TEST_EXISTS))
-                return QIcon(path);
+            if (!g_file_test(path.toUtf8(), G_FILE_TEST_EXISTS))
+                continue;
+
+            if (!strcmp(ext, "svg"))
+                files.scalablePath = path;
+            else
+                files.sizedPaths.emplace_back(path, 0);
+
+            return RasterCache::makeIcon(files);
         }
     }
 
@@ -118,55 +181,205 @@ QIcon Resources::getIcon(const QString & name)
     return QIcon();
 }
 
-Resources::AppInfoMap Resources::loadAppInfos()
+// Remembers the result of every icon lookup, including icons that were
+// not found, so that repeated requests (e.g. from tray icons) do not
+// search again. Cleared when the icon theme or its directories change.
+// If $QMPANEL_ICON_STATS is set, the hit rate is logged at each reset
+// and at exit.
+class IconCache : public QObject
 {
-    AppInfoMap apps;
+public:
+    struct Entry
+    {
+        QIcon icon;
+        IconFiles files;
+    };
+
+    static IconCache & get();
+
+    const Entry & lookup(const QString & name);
+
+    // an empty image, shown until an icon has been rendered
+    QIcon placeholder;
+
+private:
+    explicit IconCache(QObject * parent);
+    ~IconCache();
 
-    AutoPtr<GList> list(g_app_info_get_all(), [](GList * list) {
-        g_list_free_full(list, g_object_unref);
+    void reset();
+    void reportStats();
+
+    std::unordered_map<QString, Entry> mIcons;
+    QString mThemeName;
+    QFileSystemWatcher mWatcher;
+
+    bool mReportStats = !qgetenv("QMPANEL_ICON_STATS").isEmpty();
+    int mHits = 0;
+    int mMisses = 0; // names looked up for the first time
+};
+
+static IconCache * iconCache; // owned by qApp
+
+IconCache::IconCache(QObject * parent) : QObject(parent)
+{
+    int size = QApplication::style()->pixelMetric(QStyle::PM_SmallIconSize);
+    QPixmap pixmap(size, size);
+    pixmap.fill(Qt::transparent);
+    placeholder = QIcon(pixmap);
+
+    connect(&mWatcher, &QFileSystemWatcher::directoryChanged, this, [this]() {
+        IconTheme::invalidate();
+        reset();
     });
+}
+
+IconCache::~IconCache()
+{
+    reportStats();
+    iconCache = nullptr;
+}
+
+IconCache & IconCache::get()
+{
+    if (!iconCache)
+        iconCache = new IconCache(qApp);
+    if (iconCache->mThemeName != QIcon::themeName())
+        iconCache->reset();
+
+    return *iconCache;
+}
+
+void IconCache::reset()
+{
+    reportStats();
+    mIcons.clear();
+    mThemeName = QIcon::themeName();
+
+    auto dirs = IconTheme::current().baseDirs();
+    for (auto & path : QIcon::themeSearchPaths())
+    {
+        if (path.startsWith('/') && QFileInfo(path).isDir())
+            dirs.append(path);
+    }
+    for (auto dir : fallbackIconDirs)
+    {
+        if (QFileInfo(dir).isDir())
+            dirs.append(dir);
+    }
+
+    dirs.removeDuplicates();
+
+    auto watched = mWatcher.directories();
+    if (!watched.isEmpty())
+        mWatcher.removePaths(watched);
+    if (!dirs.isEmpty())
+        mWatcher.addPaths(dirs);
+}
+
+void IconCache::reportStats()
+{
+    int lookups = mHits + mMisses;
+    if (mReportStats && lookups)
+    {
+        qInfo().noquote() << "Icon cache:" << lookups << "lookups,"
+                          << mHits << "hits," << mMisses << "misses,"
+                          << mIcons.size() << "names cached";
+    }
+
+    mHits = mMisses = 0;
+}
+
+const IconCache::Entry & IconCache::lookup(const QString & name)
+{
+    auto iter = mIcons.find(name);
+    if (iter != mIcons.end())
+    {
+        mHits++;
+        return iter->second;
+    }
+
+    mMisses++;
+    Entry entry;
+    entry.icon = findIcon(name, entry.files);
+    return mIcons.emplace(name, std::move(entry)).first->second;
+}
+
+QIcon Resources::getIcon(const QString & name)
+{
+    if (g_path_is_absolute(name.toUtf8()))
+        return QIcon(name);
+
+    return IconCache::get().lookup(name).icon;
+}
+
+QIcon Resources::getIconAsync(const QString & name, const QSize & size,
+                              std::function<void(const QIcon &)> setIcon)
+{
+    if (g_path_is_absolute(name.toUtf8()))
+        return QIcon(name);
 
-    for (auto node = list.get(); node; node = node->next)
+    auto & cache = IconCache::get();
+    auto & entry = cache.lookup(name);
+    auto icon = entry.icon;
+    if (!RasterCache::instance().prerender(
+            entry.files, size, qApp->devicePixelRatio(),
+            [icon, setIcon]() { setIcon(icon); }))
+        return icon;
+
+    return cache.placeholder;
+}
+
+Resources::AppInfoMap Resources::loadAppInfos(const AppScan & scan)
+{
+    AppInfoMap apps;
+
+    AppCache cache(scan);
+    if (cache.read(apps))
+        return apps;
+
+    std::vector<QString> ids;
+    std::vector<QByteArray> paths;
+    for (auto & pair : scan.files())
+    {
+        ids.push_back(pair.first);
+        paths.push_back(pair.second.path);
+    }
+
+    auto appData = readDesktopFiles(paths);
+    for (size_t i = 0; i < ids.size(); i++)
     {
-        auto app = (GAppInfo *)node->data;
-        if (G_IS_DESKTOP_APP_INFO(app))
-            apps.emplace(g_app_info_get_id(app), (GDesktopAppInfo *)app);
+        if (appData[i])
+            apps.try_emplace(ids[i], ids[i], std::move(*appData[i]));
     }
 
+    cache.write(apps);
     return apps;
 }
 
 // Create mapping of short application name to full .desktop file name
 // Example: thunderbird -> org.mozilla.Thunderbird.desktop
-Resources::AppNameMap Resources::makeAppNameMap(AppInfoMap & appInfos)
+std::unique_ptr<AppNameMap> Resources::makeAppNameMap(
+    const AppInfoMap & appInfos)
 {
-    static QRegularExpression desktopExtRegEx("\\.desktop$");
-    static QRegularExpression beforeDotRegEx(".*\\.");
-    static QRegularExpression beforeSlashRegEx(".*\\/");
-
-    auto nameMap = AppNameMap();
+    auto nameMap = std::make_unique<AppNameMap>();
     for (auto & pair : appInfos)
-    {
-        QString name = pair.first;
-        name.remove(desktopExtRegEx);
-        name.remove(beforeDotRegEx);
-        nameMap.emplace(name.toLower(), pair.first);
+        nameMap->add(pair.first, pair.second.data());
 
-        // Also map by executable name (if different than app name)
-        // and StartupWMClass key. Maybe it's redundant to check both?
-        // Either one gives (for example): gimp-2.10 -> gimp.desktop.
-        // But "VirtualBox Manager" matches only StartupWMClass.
-        QString execName = pair.second.getExecutable();
-        execName.remove(beforeSlashRegEx);
-        if (!execName.isEmpty())
-            nameMap.emplace(execName.toLower(), pair.first);
+    return nameMap;
+}
 
-        QString wmClass = pair.second.getStartupWMClass();
-        if (!wmClass.isEmpty())
-            nameMap.emplace(wmClass.toLower(), pair.first);
+// only applications shown in the menu can be found by searching
+std::unique_ptr<SearchIndex> Resources::makeSearchIndex(
+    const AppInfoMap & appInfos)
+{
+    auto index = std::make_unique<SearchIndex>();
+    for (auto & pair : appInfos)
+    {
+        if (pair.second.categoryMask())
+            index->add(pair.first, pair.second.data());
     }
 
-    return nameMap;
+    return index;
 }
 
 Resources::Settings Resources::loadSettings()
@@ -193,8 +406,141 @@ Resources::Settings Resources::loadSettings()
             launchCmds.split(';', Qt::SkipEmptyParts)};
 }
 
+void Resources::watchApps(std::function<void(const QStringList &)> callback)
+{
+    mLoader.wait();
+
+    mAppsChanged.push_back(std::move(callback));
+    if (mWatcher)
+        return;
+
+    mWatcher = new QFileSystemWatcher(qApp);
+
+    // wait for changes to settle (e.g. during a package upgrade)
+    auto changed = [this]() {
+        if (mUpdatePending)
+            return;
+
+        mUpdatePending = true;
+        QTimer::singleShot(500, mWatcher, [this]() {
+            mUpdatePending = false;
+            updateApps();
+        });
+    };
+
+    QObject::connect(mWatcher, &QFileSystemWatcher::directoryChanged,
+                     changed);
+    QObject::connect(mWatcher, &QFileSystemWatcher::fileChanged, changed);
+
+    watchPaths();
+}
+
+// Adds any directories and files in the last scan that are not yet
+// watched (deleted ones are dropped by Qt). Files are watched as well,
+// since overwriting one in place does not change its directory.
+void Resources::watchPaths()
+{
+    auto dirs = mWatcher->directories();
+    auto files = mWatcher->files();
+    QSet<QString> watched(dirs.begin(), dirs.end());
+    watched.unite(QSet<QString>(files.begin(), files.end()));
+
+    QStringList newPaths;
+    for (auto & dir : mAppScan->dirs())
+    {
+        auto path = QString::fromUtf8(dir.path);
+        if (dir.ino && !watched.contains(path))
+            newPaths.append(path);
+    }
+
+    for (auto & pair : mAppScan->files())
+    {
+        auto & file = pair.second;
+        auto path = QString::fromUtf8(file.path);
+        // skip dangling symlinks
+        if ((file.mtimeSec || file.mtimeNsec) && !watched.contains(path))
+            newPaths.append(path);
+    }
+
+    if (!newPaths.isEmpty())
+        mWatcher->addPaths(newPaths);
+}
+
+// Compares a new directory scan with the previous one and re-reads
+// only the .desktop files that were added, removed or modified.
+void Resources::updateApps()
+{
+    auto scan = std::make_unique<AppScan>();
+    auto & oldFiles = mAppScan->files();
+    auto & newFiles = scan->files();
+    QStringList changed;
+
+    for (auto & pair : oldFiles)
+    {
+        if (newFiles.find(pair.first) == newFiles.end())
+        {
+            mAppInfos.erase(pair.first);
+            mAppNameMap->remove(pair.first);
+            changed.append(pair.first);
+        }
+    }
+
+    for (auto & pair : newFiles)
+    {
+        auto oldFile = oldFiles.find(pair.first);
+        if (oldFile != oldFiles.end() && oldFile->second == pair.second)
+            continue;
+
+        AppInfo::Data appData;
+        bool valid = readDesktopFile(pair.second.path, appData);
+        auto app = mAppInfos.find(pair.first);
+        mAppNameMap->remove(pair.first);
+        changed.append(pair.first);
+
+        if (!valid)
+        {
+            if (app != mAppInfos.end())
+                mAppInfos.erase(app);
+            continue;
+        }
+
+        if (app != mAppInfos.end())
+            app->second.update(std::move(appData));
+        else
+            app = mAppInfos
+                      .try_emplace(pair.first, pair.first, std::move(appData))
+                      .first;
+
+        mAppNameMap->add(app->first, app->second.data());
+    }
+
+    mAppScan = std::move(scan);
+    watchPaths();
+
+    if (!changed.isEmpty())
+    {
+        // copied, since a search may still be reading the old index
+        auto index = std::make_shared<SearchIndex>(*mSearchIndex);
+        for (auto & appID : changed)
+        {
+            index->remove(appID);
+            auto app = mAppInfos.find(appID);
+            if (app != mAppInfos.end() && app->second.categoryMask())
+                index->add(appID, app->second.data());
+        }
+
+        mSearchIndex = std::move(index);
+        mCategoryAppsValid = false;
+        AppCache(*mAppScan).write(mAppInfos);
+        for (auto & callback : mAppsChanged)
+            callback(changed);
+    }
+}
+
 QIcon Resources::getAppIcon(const QString & appName)
 {
+    mLoader.wait();
+
     // try exact match of appName + ".desktop" first
     auto iter = mAppInfos.find(appName + ".desktop");
     if (iter != mAppInfos.end())
@@ -206,10 +552,10 @@ QIcon Resources::getAppIcon(const QString & appName)
         return iter->second.getIcon();
 
     // try known short application names
-    auto nameIter = mAppNameMap.find(appName.toLower());
-    if (nameIter != mAppNameMap.end())
+    auto appID = mAppNameMap->find(appName);
+    if (!appID.isEmpty())
     {
-        iter = mAppInfos.find(nameIter->second);
+        iter = mAppInfos.find(appID);
         if (iter != mAppInfos.end())
             return iter->second.getIcon();
     }
@@ -218,9 +564,20 @@ QIcon Resources::getAppIcon(const QString & appName)
     return QIcon();
 }
 
+// note: appID includes ".desktop" suffix
+AppInfo * Resources::findApp(const QString & appID)
+{
+    mLoader.wait();
+
+    auto iter = mAppInfos.find(appID);
+    return (iter != mAppInfos.end()) ? &iter->second : nullptr;
+}
+
 // note: appID includes ".desktop" suffix
 QAction * Resources::getAction(const QString & appID)
 {
+    mLoader.wait();
+
     auto iter = mAppInfos.find(appID);
     if (iter != mAppInfos.end())
         return iter->second.getAction();
@@ -229,24 +586,35 @@ QAction * Resources::getAction(const QString & appID)
     return nullptr;
 }
 
-QList<QAction *> Resources::getCategory(const QString & category,
-                                        std::unordered_set<QString> & added)
+const std::vector<AppInfo *> & Resources::getCategory(int index)
 {
-    QList<QAction *> actions;
+    mLoader.wait();
 
-    for (auto & pair : mAppInfos)
+    if (!mCategoryAppsValid)
     {
-        // only add if not already in another category
-        if (pair.second.categories().contains(category, Qt::CaseInsensitive) &&
-            added.insert(pair.first).second)
+        for (auto & apps : mCategoryApps)
+            apps.clear();
+
+        for (auto & pair : mAppInfos)
         {
-            actions.append(pair.second.getAction());
+            auto mask = pair.second.categoryMask();
+            for (int i = 0; i < numMenuCategories; i++)
+            {
+                if (mask & (1u << i))
+                    mCategoryApps[i].push_back(&pair.second);
+            }
         }
-    }
 
-    std::sort(actions.begin(), actions.end(), [](QAction * a, QAction * b) {
-        return (a->text().compare(b->text(), Qt::CaseInsensitive) < 0);
-    });
+        for (auto & apps : mCategoryApps)
+        {
+            std::sort(apps.begin(), apps.end(), [](AppInfo * a, AppInfo * b) {
+                return (a->data().displayName.compare(b->data().displayName,
+                                                      Qt::CaseInsensitive) < 0);
+            });
+        }
+
+        mCategoryAppsValid = true;
+    }
 
-    return actions;
+    return mCategoryApps[index];
 }
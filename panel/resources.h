@@ -27,30 +27,86 @@
 #ifndef RESOURCES_H
 #define RESOURCES_H
 
+#include "appscan.h"
 #include "utils.h"
 
 #include <QAction>
 #include <QStringList>
+#include <functional>
+#include <future>
+#include <iterator>
 #include <unordered_map>
-#include <unordered_set>
 
-void restore_signals(void *); // from main.cpp
+class AppNameMap;
+class QFileSystemWatcher;
+class SearchIndex;
 
-typedef struct _GDesktopAppInfo GDesktopAppInfo;
+struct Category
+{
+    const char * icon;
+    const char * displayName;
+    const char * internalName;
+};
+
+// categories shown in the main menu (in order of priority)
+inline constexpr Category menuCategories[] = {
+    {"applications-development", "Development", "Development"},
+    {"applications-science", "Education", "Education"},
+    {"applications-games", "Games", "Game"},
+    {"applications-graphics", "Graphics", "Graphics"},
+    {"applications-multimedia", "Multimedia", "AudioVideo"},
+    {"applications-internet", "Network", "Network"},
+    {"applications-office", "Office", "Office"},
+    {"preferences-desktop", "Settings", "Settings"},
+    {"applications-system", "System", "System"},
+    {"applications-accessories", "Utility", "Utility"}};
+
+inline constexpr int numMenuCategories = std::size(menuCategories);
 
 class AppInfo
 {
 public:
-    explicit AppInfo(GDesktopAppInfo * info);
+    // Fields read from the .desktop file (see readDesktopFile). Only
+    // what the panel needs is kept; GIO objects (which hold the entire
+    // key file) are created only while launching the application.
+    struct Data
+    {
+        QString displayName;
+        QString icon;
+        QString executable;
+        QString startupWMClass;
+        // only for searching
+        QString genericName;
+        QString keywords;
+        QString comment;
+        // bit N is set if the application is in menuCategories[N]
+        // (always zero if the application should not be shown)
+        uint32_t categoryMask = 0;
+    };
+
+    AppInfo(const QString & id, Data && data);
+
+    // replaces fields after the .desktop file was modified
+    void update(Data && data);
+
+    const QString & id() const { return mID; }
+    const Data & data() const { return mData; }
+
+    uint32_t categoryMask() const { return mData.categoryMask; }
 
-    QStringList categories() const;
     QIcon getIcon() const;
-    QString getExecutable() const;
-    QString getStartupWMClass() const;
     QAction * getAction();
+    // null if not yet created (or released)
+    QAction * action() const { return mAction.get(); }
+    // deletes the action if it is not currently added to any widget
+    void releaseAction();
 
 private:
-    AutoPtrV<GDesktopAppInfo> mInfo;
+    void updateIcon();
+    void launch();
+
+    QString mID;
+    Data mData;
     std::unique_ptr<QAction> mAction;
 };
 
@@ -65,26 +121,73 @@ public:
         QStringList launchCmds;
     };
 
+    using AppInfoMap = std::unordered_map<QString, AppInfo>;
+
+    // Starts loading applications and settings in a background thread.
+    // This needs no GUI state and can be done before QApplication is
+    // created. Other member functions wait for loading to complete.
+    Resources();
+    ~Resources();
+
+    // results (including icons not found) are cached per name
     static QIcon getIcon(const QString & name);
+    // Like getIcon(), but returns a placeholder if the icon must first be
+    // rendered at the given size. setIcon() is then called when ready.
+    static QIcon getIconAsync(const QString & name, const QSize & size,
+                              std::function<void(const QIcon &)> setIcon);
+
+    const Settings & settings() const
+    {
+        mLoader.wait();
+        return mSettings;
+    }
 
-    const Settings & settings() const { return mSettings; }
+    // Watches application directories for changes (once for all callers).
+    // Each callback receives the IDs of all applications added, removed
+    // or modified. Actions of removed applications are deleted first.
+    void watchApps(std::function<void(const QStringList & appIDs)> callback);
 
     QIcon getAppIcon(const QString & appName);
+    AppInfo * findApp(const QString & appID);
     QAction * getAction(const QString & appID);
-    QList<QAction *> getCategory(const QString & category,
-                                 std::unordered_set<QString> & added);
 
-private:
-    using AppInfoMap = std::unordered_map<QString, AppInfo>;
-    using AppNameMap = std::unordered_map<QString, QString>;
+    // replaced by a new index (not modified) when applications change
+    std::shared_ptr<const SearchIndex> searchIndex() const
+    {
+        mLoader.wait();
+        return mSearchIndex;
+    }
+    // sorted by name (actions are not created here)
+    const std::vector<AppInfo *> & getCategory(int index);
 
-    static AppInfoMap loadAppInfos();
-    static AppNameMap makeAppNameMap(AppInfoMap & appInfos);
+private:
+    static AppInfoMap loadAppInfos(const AppScan & scan);
+    static std::unique_ptr<AppNameMap> makeAppNameMap(
+        const AppInfoMap & appInfos);
+    static std::unique_ptr<SearchIndex> makeSearchIndex(
+        const AppInfoMap & appInfos);
     static Settings loadSettings();
 
-    AppInfoMap mAppInfos = loadAppInfos();
-    AppNameMap mAppNameMap = makeAppNameMap(mAppInfos);
-    Settings mSettings = loadSettings();
+    void watchPaths();
+    void updateApps();
+
+    std::unique_ptr<AppScan> mAppScan;
+    AppInfoMap mAppInfos;
+    std::unique_ptr<AppNameMap> mAppNameMap;
+    std::shared_ptr<const SearchIndex> mSearchIndex;
+    Settings mSettings;
+
+    // applications in each menu category, sorted by name (built when
+    // first needed and rebuilt after any applications change)
+    std::vector<AppInfo *> mCategoryApps[numMenuCategories];
+    bool mCategoryAppsValid = false;
+
+    QFileSystemWatcher * mWatcher = nullptr; // owned by qApp
+    bool mUpdatePending = false;
+    std::vector<std::function<void(const QStringList & appIDs)>> mAppsChanged;
+
+    // declared last so that it is waited for before the above are freed
+    std::future<void> mLoader;
 };
 
 #endif
@@ -0,0 +1,162 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * qmpanel - a minimal Qt-based desktop panel
+ *
+ * Copyright: 2026 John Lindgren
+ * Authors:
+ *   John Lindgren <john@jlindgren.net>
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "searchindex.h"
+
+#include <algorithm>
+
+QStringList SearchIndex::splitWords(const QString & text)
+{
+    QStringList words;
+    QString word;
+
+    for (QChar c : text.toCaseFolded())
+    {
+        if (c.isLetterOrNumber())
+            word.append(c);
+        else if (!word.isEmpty())
+        {
+            words.append(word);
+            word.clear();
+        }
+    }
+
+    if (!word.isEmpty())
+        words.append(word);
+
+    return words;
+}
+
+void SearchIndex::add(const QString & appID, const AppInfo::Data & data)
+{
+    std::map<QString, int> words;
+    auto addWords = [&words](const QString & text, int field) {
+        for (auto & word : splitWords(text))
+            words[word] |= field;
+    };
+
+    addWords(data.displayName, Name);
+    addWords(data.genericName, GenericName);
+    addWords(data.keywords, Keywords);
+    addWords(data.comment, Comment);
+    addWords(data.executable.section('/', -1), Executable);
+
+    // reuse the index of a removed application if possible
+    uint32_t app;
+    if (!mFreeApps.empty())
+    {
+        app = mFreeApps.back();
+        mFreeApps.pop_back();
+        mAppIDs[app] = appID;
+    }
+    else
+    {
+        app = mAppIDs.size();
+        mAppIDs.push_back(appID);
+        mAppWords.emplace_back();
+    }
+
+    mAppIndex[appID] = app;
+
+    for (auto & pair : words)
+    {
+        mWords[pair.first].push_back({app, pair.second});
+        mAppWords[app].append(pair.first);
+    }
+}
+
+void SearchIndex::remove(const QString & appID)
+{
+    auto iter = mAppIndex.find(appID);
+    if (iter == mAppIndex.end())
+        return;
+
+    uint32_t app = iter->second;
+    for (auto & word : mAppWords[app])
+    {
+        auto & postings = mWords[word];
+        postings.erase(std::remove_if(postings.begin(), postings.end(),
+                                      [app](const Posting & posting) {
+                                          return posting.app == app;
+                                      }),
+                       postings.end());
+        if (postings.empty())
+            mWords.erase(word);
+    }
+
+    // postings need not be in order, so the index can be reused
+    mAppIDs[app].clear();
+    mAppWords[app].clear();
+    mAppIndex.erase(iter);
+    mFreeApps.push_back(app);
+}
+
+SearchIndex::Matches SearchIndex::find(const QString & searchStr) const
+{
+    std::unordered_map<uint32_t, int> found;
+    bool first = true;
+
+    for (auto & snippet : splitWords(searchStr))
+    {
+        // all words starting with the snippet
+        std::unordered_map<uint32_t, int> hits;
+        for (auto iter = mWords.lower_bound(snippet);
+             iter != mWords.end() && iter->first.startsWith(snippet); ++iter)
+        {
+            for (auto & posting : iter->second)
+                hits[posting.app] |= posting.fields;
+        }
+
+        if (first)
+        {
+            found = std::move(hits);
+            first = false;
+        }
+        else
+        {
+            for (auto iter = found.begin(); iter != found.end();)
+            {
+                auto hit = hits.find(iter->first);
+                if (hit == hits.end())
+                    iter = found.erase(iter);
+                else
+                {
+                    iter->second &= hit->second;
+                    ++iter;
+                }
+            }
+        }
+
+        if (found.empty())
+            break;
+    }
+
+    Matches matches;
+    for (auto & pair : found)
+        matches.emplace(mAppIDs[pair.first], pair.second);
+
+    return matches;
+}
@@ -0,0 +1,78 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * qmpanel - a minimal Qt-based desktop panel
+ *
+ * Copyright: 2026 John Lindgren
+ * Authors:
+ *   John Lindgren <john@jlindgren.net>
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef SEARCHINDEX_H
+#define SEARCHINDEX_H
+
+#include "resources.h"
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+// Inverted index of the words in each application's name, generic name,
+// keywords, comment and executable name. A search looks up the words
+// starting with each snippet and intersects their lists of applications,
+// rather than scanning every application.
+class SearchIndex
+{
+public:
+    enum Field
+    {
+        Name = (1 << 0),
+        GenericName = (1 << 1),
+        Keywords = (1 << 2),
+        Comment = (1 << 3),
+        Executable = (1 << 4)
+    };
+
+    // maps application IDs to the fields in which every snippet was found
+    using Matches = std::unordered_map<QString, int>;
+
+    // splits into case-folded words (at anything but letters and digits)
+    static QStringList splitWords(const QString & text);
+
+    void add(const QString & appID, const AppInfo::Data & data);
+    void remove(const QString & appID);
+
+    Matches find(const QString & searchStr) const;
+
+private:
+    struct Posting
+    {
+        uint32_t app;
+        int fields;
+    };
+
+    // sorted, so that all words with a given prefix are adjacent
+    std::map<QString, std::vector<Posting>> mWords;
+    std::vector<QString> mAppIDs; // empty for removed applications
+    std::unordered_map<QString, uint32_t> mAppIndex;
+    std::vector<QStringList> mAppWords;
+    std::vector<uint32_t> mFreeApps; // indexes of removed applications
+};
+
+#endif
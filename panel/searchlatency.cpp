@@ -0,0 +1,157 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * qmpanel - a minimal Qt-based desktop panel
+ *
+ * Copyright: 2026 John Lindgren
+ * Authors:
+ *   John Lindgren <john@jlindgren.net>
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "searchlatency.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QKeyEvent>
+#include <QLineEdit>
+#include <QMenu>
+#include <algorithm>
+#include <iterator>
+
+// delays before typing the script, between keys, and before quitting
+static const int scriptStartMs = 1000;
+static const int scriptKeyMs = 50;
+static const int scriptEndMs = 500;
+
+// upper bounds of the histogram buckets, in ms (the last is unbounded)
+static const int bucketMs[] = {1, 2, 4, 8, 16, 32, 64, 128, 256};
+
+std::unique_ptr<SearchLatency> SearchLatency::create(QMenu * menu,
+                                                     QLineEdit * edit)
+{
+    auto script = qgetenv("QMPANEL_SEARCH_SCRIPT");
+    if (script.isEmpty() && qgetenv("QMPANEL_SEARCH_LATENCY").isEmpty())
+        return nullptr;
+
+    return std::unique_ptr<SearchLatency>(
+        new SearchLatency(menu, edit, QString::fromUtf8(script)));
+}
+
+SearchLatency::SearchLatency(QMenu * menu, QLineEdit * edit,
+                             const QString & script)
+    : mMenu(menu), mEdit(edit), mScript(script)
+{
+    mClock.start();
+
+    if (mScript.isEmpty())
+        return;
+
+    mTypeTimer.setInterval(scriptKeyMs);
+    QObject::connect(&mTypeTimer, &QTimer::timeout, [this]() { typeNext(); });
+
+    QTimer::singleShot(scriptStartMs, mMenu, [this]() {
+        mMenu->popup(QPoint());
+        mEdit->setFocus();
+        mTypeTimer.start();
+    });
+}
+
+void SearchLatency::textChanged() { mPending.push_back(mClock.nsecsElapsed()); }
+
+void SearchLatency::resultsShown()
+{
+    mShown.insert(mShown.end(), mPending.begin(), mPending.end());
+    mPending.clear();
+}
+
+void SearchLatency::framePainted()
+{
+    int64_t now = mClock.nsecsElapsed();
+    for (int64_t time : mShown)
+        mLatencies.push_back((now - time) / 1000);
+
+    mShown.clear();
+}
+
+// Called as the menu hides. The search is cleared just before, but that
+// is never painted, so it must not be counted on the next showing.
+void SearchLatency::report()
+{
+    mPending.clear();
+    mShown.clear();
+
+    if (mLatencies.empty())
+        return;
+
+    auto sorted = mLatencies;
+    std::sort(sorted.begin(), sorted.end());
+
+    size_t count = sorted.size();
+    auto ms = [](int64_t us) { return QString::number(us / 1000.0, 'f', 1); };
+
+    qInfo().noquote() << "Search latency:" << count << "keystrokes, p50"
+                      << ms(sorted[count / 2]) << "ms, p99"
+                      << ms(sorted[std::min(count - 1, count * 99 / 100)])
+                      << "ms, max" << ms(sorted.back()) << "ms";
+
+    QString histogram;
+    auto bucketStart = sorted.begin();
+    for (int bound : bucketMs)
+    {
+        auto bucketEnd =
+            std::lower_bound(bucketStart, sorted.end(), bound * 1000);
+        int inBucket = bucketEnd - bucketStart;
+        histogram += QString(" <%1ms:%2").arg(bound).arg(inBucket);
+        bucketStart = bucketEnd;
+    }
+
+    int lastBound = bucketMs[std::size(bucketMs) - 1];
+    int inLast = sorted.end() - bucketStart;
+    histogram += QString(" >=%1ms:%2").arg(lastBound).arg(inLast);
+
+    qInfo().noquote() << "Search latency histogram:" << histogram;
+    mLatencies.clear();
+}
+
+void SearchLatency::typeNext()
+{
+    if (mScriptPos >= mScript.size())
+    {
+        mTypeTimer.stop();
+        QTimer::singleShot(scriptEndMs, mMenu, [this]() {
+            report();
+            QCoreApplication::quit();
+        });
+        return;
+    }
+
+    QChar c = mScript[mScriptPos++];
+    if (c == '|')
+    {
+        mEdit->clear();
+        return;
+    }
+
+    // sent through the event queue, as real keys would be
+    int key = c.toUpper().unicode();
+    QCoreApplication::postEvent(
+        mEdit, new QKeyEvent(QEvent::KeyPress, key, Qt::NoModifier, c));
+    QCoreApplication::postEvent(
+        mEdit, new QKeyEvent(QEvent::KeyRelease, key, Qt::NoModifier, c));
+}
@@ -0,0 +1,79 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * qmpanel - a minimal Qt-based desktop panel
+ *
+ * Copyright: 2026 John Lindgren
+ * Authors:
+ *   John Lindgren <john@jlindgren.net>
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef SEARCHLATENCY_H
+#define SEARCHLATENCY_H
+
+#include <QElapsedTimer>
+#include <QString>
+#include <QTimer>
+#include <memory>
+#include <vector>
+
+class QLineEdit;
+class QMenu;
+
+// Measures the time from each change of the search text until the menu
+// is painted with results that include it, when QMPANEL_SEARCH_LATENCY
+// is set. A histogram is printed each time the menu is closed.
+//
+// If QMPANEL_SEARCH_SCRIPT is set instead, the menu is opened shortly
+// after startup and the given text typed into it, one key every 50 ms
+// ('|' clears the search). The histogram is then printed and the panel
+// quits, so that this can be run under "-platform offscreen".
+class SearchLatency
+{
+public:
+    // returns null unless enabled
+    static std::unique_ptr<SearchLatency> create(QMenu * menu,
+                                                 QLineEdit * edit);
+
+    void textChanged();
+    void resultsShown();
+    // call once the whole menu has been painted
+    void framePainted();
+    void report();
+
+private:
+    SearchLatency(QMenu * menu, QLineEdit * edit, const QString & script);
+
+    void typeNext();
+
+    QMenu * mMenu;
+    QLineEdit * mEdit;
+    QElapsedTimer mClock;
+
+    // times (in ns) of text changes not yet shown and not yet painted
+    std::vector<int64_t> mPending;
+    std::vector<int64_t> mShown;
+    std::vector<int64_t> mLatencies; // in us
+
+    QString mScript;
+    int mScriptPos = 0;
+    QTimer mTypeTimer;
+};
+
+#endif
@@ -0,0 +1,44 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * qmpanel - a minimal Qt-based desktop panel
+ *
+ * Copyright: 2026 John Lindgren
+ * Authors:
+ *   John Lindgren <john@jlindgren.net>
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "stringfilter.h"
+
+uint64_t charMask(const QString & str)
+{
+    uint64_t mask = 0;
+    for (QChar c : str)
+    {
+        char16_t u = c.unicode();
+        if (u >= 'a' && u <= 'z')
+            mask |= uint64_t(1) << (u - 'a');
+        else if (u >= '0' && u <= '9')
+            mask |= uint64_t(1) << (26 + u - '0');
+        else if (u != ' ')
+            mask |= uint64_t(1) << 63;
+    }
+
+    return mask;
+}
@@ -0,0 +1,143 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * qmpanel - a minimal Qt-based desktop panel
+ *
+ * Copyright: 2026 John Lindgren
+ * Authors:
+ *   John Lindgren <john@jlindgren.net>
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef STRINGFILTER_H
+#define STRINGFILTER_H
+
+#include "searchindex.h"
+
+#include <QString>
+#include <algorithm>
+#include <stdint.h>
+
+// One bit for each letter or digit in a (case-folded) string, and one
+// more for any other character. A string can only contain another as
+// a subsequence if it has all the bits of the other.
+uint64_t charMask(const QString & str);
+
+// Matches items found in the search index (whose words start with every
+// snippet of the search, in any order), or failing that, which contain
+// the search (without spaces) as a subsequence. Matches are scored so
+// that index matches come first (name matches before other fields),
+// followed by those matching at word starts (acronyms) and in runs.
+class StringFilter
+{
+public:
+    const QString & searchStr() const { return mSearchStr; }
+    uint64_t charMask() const { return mCharMask; }
+
+    // surrounding spaces are dropped (so that only spaces are no search)
+    void setSearchStr(const QString & str)
+    {
+        mSearchStr = str.trimmed();
+        mChars = mSearchStr.toCaseFolded().remove(' ');
+        mCharMask = ::charMask(mChars);
+    }
+
+    // Returns -1 if not matched, otherwise higher is better. The text
+    // must be case-folded. The fields are those found by the search
+    // index (-1 if none).
+    int score(const QString & folded, int fields) const
+    {
+        int score = fuzzyScore(folded);
+        if (fields >= 0)
+        {
+            int tier = (fields & SearchIndex::Name) ? 2000 : 1000;
+            score = tier * 64 + std::max(score, 0);
+        }
+
+        return score;
+    }
+
+private:
+    static bool isWordStart(const QString & text, int i)
+    {
+        return i == 0 || text[i - 1] == ' ' || text[i - 1] == '-';
+    }
+
+    // Matching each character at its first occurrence can miss a later
+    // word start (e.g. "fb" in "fab bar" would match "fab"). So if any
+    // character matched within a word (and not in a run), a second pass
+    // moves such matches to the next word start with that character.
+    // That pass may fail where the first succeeded, so the better score
+    // is taken.
+    int fuzzyScore(const QString & text) const
+    {
+        bool withinWord = false;
+        int score = fuzzyScore(text, false, withinWord);
+        if (score >= 0 && withinWord)
+            score = std::max(score, fuzzyScore(text, true, withinWord));
+
+        return score;
+    }
+
+    int fuzzyScore(const QString & text, bool preferStarts,
+                   bool & withinWord) const
+    {
+        int score = 0, next = 0, last = -2;
+        for (int i = 0; i < text.size() && next < mChars.size(); i++)
+        {
+            if (text[i] != mChars[next])
+                continue;
+
+            bool start = isWordStart(text, i);
+            if (!start && i != last + 1)
+            {
+                withinWord = true;
+                for (int j = i + 1; preferStarts && j < text.size(); j++)
+                {
+                    if (text[j] == mChars[next] && isWordStart(text, j))
+                    {
+                        i = j;
+                        start = true;
+                        break;
+                    }
+                }
+            }
+
+            score += 1;
+            if (start)
+                score += 10;
+            if (i == last + 1)
+                score += 5;
+
+            last = i;
+            next++;
+        }
+
+        if (next < mChars.size())
+            return -1;
+
+        // prefer shorter names when otherwise equal
+        return score * 64 - std::min<int>(text.size(), 63);
+    }
+
+    QString mSearchStr;
+    QString mChars;
+    uint64_t mCharMask = 0;
+};
+
+#endif
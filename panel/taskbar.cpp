@@ -30,6 +30,7 @@
  * END_COMMON_COPYRIGHT_HEADER */
 
 #include "taskbar.h"
+#include "launchtracker.h"
 #include "taskbutton.h"
 #include "wlr-foreign-toplevel-management-unstable-v1.h"
 
@@ -88,6 +89,24 @@ TaskBar::TaskBar(Resources & res, QWidget * parent)
     }
 }
 
+void TaskBar::watchWindows(std::function<void(TaskButton *)> callback)
+{
+    mWindowAdded = std::move(callback);
+
+    for (int i = 0; i < mLayout.count(); i++)
+    {
+        auto button = dynamic_cast<TaskButton *>(mLayout.itemAt(i)->widget());
+        if (button)
+            windowAdded(button);
+    }
+}
+
+void TaskBar::windowAdded(TaskButton * button)
+{
+    if (mWindowAdded)
+        mWindowAdded(button);
+}
+
 void TaskBar::addToplevelManager(wl_registry * registry, uint32_t name,
                                  uint32_t version)
 {
@@ -125,6 +144,7 @@ void TaskBar::addWindow(zwlr_foreign_toplevel_handle_v1 * handle)
 {
     auto button = new TaskButtonWayland(mRes, handle, this);
     mLayout.insertWidget(mLayout.count() - 1, button);
+    windowAdded(button);
 }
 
 bool TaskBar::acceptWindow(WId window) const
@@ -160,6 +180,17 @@ void TaskBar::addWindow(WId window)
         auto button = new TaskButtonX11(window, this);
         mLayout.insertWidget(mLayout.count() - 1, button);
         mKnownWindows[window] = button;
+        windowAdded(button);
+
+        // avoid a round trip to the X server if no launch is pending
+        auto & tracker = LaunchTracker::instance();
+        if (tracker.hasPending())
+        {
+            KWindowInfo info(window, NET::WMPid, NET::WM2WindowClass);
+            tracker.windowAdded(
+                info.pid(), {QString::fromUtf8(info.windowClassName()),
+                             QString::fromUtf8(info.windowClassClass())});
+        }
     }
 }
 
@@ -35,9 +35,11 @@
 #include <NETWM>
 #include <QHBoxLayout>
 #include <QWidget>
+#include <functional>
 #include <unordered_map>
 
 class Resources;
+class TaskButton;
 class TaskButtonX11;
 class TaskButtonWayland;
 
@@ -50,6 +52,11 @@ class TaskBar : public QWidget
 public:
     explicit TaskBar(Resources & res, QWidget * parent);
 
+    // The callback is called for each window (button) now present and
+    // then for each one added later. Buttons are deleted when their
+    // windows are closed.
+    void watchWindows(std::function<void(TaskButton * button)> callback);
+
     // Wayland-specific
     void addToplevelManager(wl_registry * registry, uint32_t name,
                             uint32_t version);
@@ -65,9 +72,12 @@ private:
     void onWindowChanged(WId window, NET::Properties prop,
                          NET::Properties2 prop2);
 
+    void windowAdded(TaskButton * button);
+
     Resources & mRes;
     std::unordered_map<WId, TaskButtonX11 *> mKnownWindows;
     QHBoxLayout mLayout;
+    std::function<void(TaskButton * button)> mWindowAdded;
 };
 
 #endif // TASKBAR_H
@@ -29,6 +29,7 @@
  * END_COMMON_COPYRIGHT_HEADER */
 
 #include "taskbutton.h"
+#include "launchtracker.h"
 #include "resources.h"
 #include "wlr-foreign-toplevel-management-unstable-v1.h"
 
@@ -58,6 +59,7 @@ TaskButton::TaskButton(QWidget * parent) : QToolButton(parent)
     });
 
     connect(&mTimer, &QTimer::timeout, this, &TaskButton::activateWindow);
+    connect(&mAction, &QAction::triggered, [this]() { activateWindow(); });
 }
 
 QSize TaskButton::sizeHint() const
@@ -65,6 +67,19 @@ QSize TaskButton::sizeHint() const
     return {2 * logicalDpiX(), QToolButton::sizeHint().height()};
 }
 
+void TaskButton::setTitle(const QString & title)
+{
+    setText(QString(title).replace("&", "&&"));
+    setToolTip(title);
+    mAction.setText(title);
+}
+
+void TaskButton::setTaskIcon(const QIcon & icon)
+{
+    setIcon(icon);
+    mAction.setIcon(icon);
+}
+
 void TaskButton::dragEnterEvent(QDragEnterEvent * event)
 {
     mTimer.start();
@@ -113,8 +128,7 @@ void TaskButtonX11::updateText()
     if (title.isEmpty())
         title = info.name();
 
-    setText(title.replace("&", "&&"));
-    setToolTip(title);
+    setTitle(title);
 }
 
 void TaskButtonX11::updateIcon()
@@ -124,7 +138,7 @@ void TaskButtonX11::updateIcon()
     QIcon icon = KX11Extras::icon(mWindow, size, size);
     if (icon.isNull())
         icon = style()->standardIcon(QStyle::SP_FileIcon);
-    setIcon(icon);
+    setTaskIcon(icon);
 }
 
 void TaskButtonX11::activateWindow()
@@ -152,9 +166,7 @@ TaskButtonWayland::TaskButtonWayland(Resources & res,
             .title =
                 [](void * data, zwlr_foreign_toplevel_handle_v1 * handle,
                    const char * title) {
-                    auto self = static_cast<TaskButtonWayland *>(data);
-                    self->setText(QString(title).replace("&", "&&"));
-                    self->setToolTip(title);
+                    static_cast<TaskButtonWayland *>(data)->setTitle(title);
                 },
             .app_id =
                 [](void * data, zwlr_foreign_toplevel_handle_v1 * handle,
@@ -204,7 +216,7 @@ TaskButtonWayland::TaskButtonWayland(Resources & res,
                                                  this);
 
     // set default icon (usually changed from app_id callback)
-    setIcon(style()->standardIcon(QStyle::SP_FileIcon));
+    setTaskIcon(style()->standardIcon(QStyle::SP_FileIcon));
 }
 
 TaskButtonWayland::~TaskButtonWayland()
@@ -235,7 +247,15 @@ void TaskButtonWayland::closeWindow()
 
 void TaskButtonWayland::setAppName(const QString & appName)
 {
+    // The process ID is not known under Wayland. Only the first app_id
+    // is for a new window, since it may be sent again (or changed).
+    auto & tracker = LaunchTracker::instance();
+    if (!mAppNameSeen && tracker.hasPending())
+        tracker.windowAdded(0, {appName});
+
+    mAppNameSeen = true;
+
     auto icon = mRes.getAppIcon(appName);
     if (!icon.isNull())
-        setIcon(icon);
+        setTaskIcon(icon);
 }
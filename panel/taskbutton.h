@@ -31,6 +31,7 @@
 #ifndef TASKBUTTON_H
 #define TASKBUTTON_H
 
+#include <QAction>
 #include <QTimer>
 #include <QToolButton>
 
@@ -42,9 +43,16 @@ class TaskButton : public QToolButton
 public:
     QSize sizeHint() const override;
 
+    // has the window title and icon, and activates the window (used to
+    // list windows in the main menu search)
+    QAction * action() { return &mAction; }
+
 protected:
     TaskButton(QWidget * parent);
 
+    void setTitle(const QString & title);
+    void setTaskIcon(const QIcon & icon);
+
     void dragEnterEvent(QDragEnterEvent * event) override;
     void dragLeaveEvent(QDragLeaveEvent * event) override;
     void dropEvent(QDropEvent * event) override;
@@ -56,6 +64,7 @@ protected:
 
 private:
     QTimer mTimer;
+    QAction mAction;
 };
 
 class TaskButtonX11 : public TaskButton
@@ -99,6 +108,7 @@ private:
     Resources & mRes;
     zwlr_foreign_toplevel_handle_v1 * const mHandle;
     bool isActive = false;
+    bool mAppNameSeen = false; // reported to LaunchTracker once
 };
 
 #endif // TASKBUTTON_H